@@ -29,13 +29,28 @@ namespace tp5
   using mth::max;
   using mth::abs;
 
+  /* Renderer scalar type, single precision with TP5_FLOAT build option */
+#ifdef TP5_FLOAT
+  typedef float real;
+#else /* TP5_FLOAT */
+  typedef double real;
+#endif /* TP5_FLOAT */
+
   /* Project type defenitions */
-  typedef mth::vec2<double>   vec2;
-  typedef mth::vec3<double>   vec3;
-  typedef mth::vec4<double>   vec4;
-  typedef mth::matr<double>   matr;
-  typedef mth::ray<double>    ray;
-  typedef mth::camera<double> camera;
+  typedef mth::vec2<real>   vec2;
+  typedef mth::vec3<real>   vec3;
+  typedef mth::vec4<real>   vec4;
+  typedef mth::matr<real>   matr;
+  typedef mth::ray<real>    ray;
+  typedef mth::camera<real> camera;
+
+  /* Random numbers and samplers (see 'mth_rnd.h') */
+  using mth::rnd;
+  using mth::sampler;
+  using mth::blue_noise;
+
+  /* Double precision vector for numerically sensitive code */
+  typedef mth::vec3<double> dvec3;
 
   /* Stock container representation type. */
   template<typename Type>
@@ -1,28 +1,41 @@
+#include <array>
+#include <cmath>
+#include <cstdio>
+
 #include "frame.h"
+#include "writer.h"
+#include "mth/mth_simd.h"
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "lib/stb_image_write.h"
 
+#define STB_IMAGE_IMPLEMENTATION
+#include "lib/stb_image.h"
+
 namespace tp5
 {
 
-frame::frame( int W, int H ) : width(W), height(H), pixels(nullptr)
+frame::frame( int W, int H ) : width(W), height(H), pixels(nullptr), hdr(nullptr)
 {
   pixels = new dword[W * H];
+  hdr = new float[W * H * 4]();
 }
 
 void frame::Resize( int NewW, int NewH )
 {
-  const std::lock_guard<std::recursive_mutex> lock(frame_mutex);
+  const std::lock_guard<std::mutex> lock(frame_mutex);
 
   if (pixels != nullptr)
     delete[] pixels;
+  delete[] hdr;
   pixels = nullptr;
+  hdr = nullptr;
   width = height = 0;
   if (NewW != 0 && NewH != 0)
   {
     pixels = new dword[NewW * NewH];
     memset(pixels, 0, NewW * NewH * 4);
+    hdr = new float[NewW * NewH * 4]();
     width = NewW;
     height = NewH;
   }
@@ -30,8 +43,6 @@ void frame::Resize( int NewW, int NewH )
 
 void frame::PutPixel( int X, int Y, dword Color )
 {
-  const std::lock_guard<std::recursive_mutex> lock(frame_mutex);
-
   if (X < 0 || Y < 0 || X >= width || Y >= height)
     return;
   pixels[X + Y * width] = Color;
@@ -39,29 +50,139 @@ void frame::PutPixel( int X, int Y, dword Color )
 
 dword frame::GetPixel( int X, int Y ) const
 {
-  const std::lock_guard<std::recursive_mutex> lock(frame_mutex);
-
   if (X < 0 || Y < 0 || X >= width || Y >= height)
     return 0;
   return pixels[X + Y * width];
 }
 
+void frame::PutTile( int X0, int Y0, int W, int H, const dword *Tile )
+{
+  int
+    x0 = X0 < 0 ? 0 : X0, x1 = X0 + W > width ? width : X0 + W,
+    y0 = Y0 < 0 ? 0 : Y0, y1 = Y0 + H > height ? height : Y0 + H;
+
+  for (int y = y0; y < y1 && x0 < x1; y++)
+    memcpy(pixels + y * width + x0, Tile + (y - Y0) * W + x0 - X0, (x1 - x0) * sizeof(dword));
+}
+
+/* sRGB encode table by linear value in [0, 1] * 4095 */
+static const std::array<byte, 4096> SrgbTable = []( void )
+{
+  std::array<byte, 4096> t;
+
+  for (int i = 0; i < 4096; i++)
+  {
+    double v = i / 4095.0;
+
+    v = v <= 0.0031308 ? v * 12.92 : 1.055 * pow(v, 1 / 2.4) - 0.055;
+    t[i] = (byte)(v * 255 + 0.5);
+  }
+  return t;
+}();
+
+/* Exposure, tonemap curve and encoding of one pixel. Color channels go
+ * in one 4 wide pack, alpha is only clamped. */
+dword frame::Develop( const float *Color ) const
+{
+  using mth::simd4;
+  const simd4 zero(0), one(1);
+  simd4 v = Max(simd4::Load(Color) * simd4(develop.exposure), zero);
+  float c[4], a = Color[3] < 0 ? 0 : Color[3] > 1 ? 1 : Color[3];
+
+  if (develop.tone == tonemap::REINHARD)
+    v = v / (one + v);
+  else if (develop.tone == tonemap::ACES)
+    v = v * (simd4(2.51f) * v + simd4(0.03f)) / (v * (simd4(2.43f) * v + simd4(0.59f)) + simd4(0.14f));
+  v = Min(v, one);
+  if (develop.srgb)
+  {
+    (v * simd4(4095) + simd4(0.5f)).Store(c);
+    return RGBA(SrgbTable[(int)c[0]], SrgbTable[(int)c[1]], SrgbTable[(int)c[2]], (byte)(a * 255));
+  }
+  (v * simd4(255)).Store(c);
+  return RGBA((byte)c[0], (byte)c[1], (byte)c[2], (byte)(a * 255));
+}
+
+void frame::Develop( int X0, int Y0, int W, int H )
+{
+  int
+    x0 = X0 < 0 ? 0 : X0, x1 = X0 + W > width ? width : X0 + W,
+    y0 = Y0 < 0 ? 0 : Y0, y1 = Y0 + H > height ? height : Y0 + H;
+
+  for (int y = y0; y < y1; y++)
+    for (int x = x0; x < x1; x++)
+      pixels[y * width + x] = Develop(hdr + (y * width + x) * 4);
+}
+
+void frame::PutHdrTile( int X0, int Y0, int W, int H, const float *Tile )
+{
+  int
+    x0 = X0 < 0 ? 0 : X0, x1 = X0 + W > width ? width : X0 + W,
+    y0 = Y0 < 0 ? 0 : Y0, y1 = Y0 + H > height ? height : Y0 + H;
+
+  for (int y = y0; y < y1 && x0 < x1; y++)
+    memcpy(hdr + (y * width + x0) * 4, Tile + ((y - Y0) * W + x0 - X0) * 4, (x1 - x0) * 4 * sizeof(float));
+  Develop(X0, Y0, W, H);
+}
+
+void frame::PutHdrRect( int X0, int Y0, int W, int H, float R, float G, float B )
+{
+  int
+    x0 = X0 < 0 ? 0 : X0, x1 = X0 + W > width ? width : X0 + W,
+    y0 = Y0 < 0 ? 0 : Y0, y1 = Y0 + H > height ? height : Y0 + H;
+  const float c[4] = {R, G, B, 1};
+
+  if (x0 >= x1 || y0 >= y1)
+    return;
+
+  dword p = Develop(c);
+
+  for (int y = y0; y < y1; y++)
+    for (int x = x0; x < x1; x++)
+    {
+      memcpy(hdr + (y * width + x) * 4, c, sizeof(c));
+      pixels[y * width + x] = p;
+    }
+}
+
+void frame::SetDevelop( const develop_params &Params )
+{
+  const std::lock_guard<std::mutex> lock(frame_mutex);
+
+  develop = Params;
+  if (pixels != nullptr)
+    Develop(0, 0, width, height);
+}
+
+const frame::develop_params & frame::GetDevelop( void ) const
+{
+  return develop;
+}
+
 void frame::Clear( dword Color )
 {
-  const std::lock_guard<std::recursive_mutex> lock(frame_mutex);
+  const std::lock_guard<std::mutex> lock(frame_mutex);
 
   int i = width * height;
   dword *p = pixels;
+  float *h = hdr;
   if (p == 0)
     return;
   while (i-- > 0)
+  {
     *p++ = Color;
+    *h++ = (Color >> 24) / 255.0f;
+    *h++ = (Color >> 16 & 0xFF) / 255.0f;
+    *h++ = (Color >> 8 & 0xFF) / 255.0f;
+    *h++ = (Color & 0xFF) / 255.0f;
+  }
 }
 
 void frame::Clear( void )
 {
-  const std::lock_guard<std::recursive_mutex> lock(frame_mutex);
+  const std::lock_guard<std::mutex> lock(frame_mutex);
   memset(pixels, 0, width * height * 4);
+  memset(hdr, 0, width * height * 4 * sizeof(float));
 }
 
 dword frame::RGBA( byte R, byte G, byte B, byte A )
@@ -69,28 +190,47 @@ dword frame::RGBA( byte R, byte G, byte B, byte A )
   return (R << 24) | (G << 16) | (B << 8) | A;
 }
 
+/* Saves in calling thread, format goes from path extension
+ * (see 'image_writer' for saving in background) */
 void frame::Save( const char *Path ) const
 {
-  const std::lock_guard<std::recursive_mutex> lock(frame_mutex);
+  image_writer::Save(image_writer::Snapshot(*this, Path));
+}
+
+/* Linear colors are saved as PFM (RGB, rows bottom to top) for '.pfm'
+ * paths and as raw RGBA floats (rows top to bottom) otherwise. */
+void frame::SaveHdr( const char *Path ) const
+{
+  const std::lock_guard<std::mutex> lock(frame_mutex);
 
-  dword *pixels_c = new dword[width * height];
-  memcpy(pixels_c, pixels, 4 * width * height); 
-  for (int i = 0; i < width * height; ++i)
-    pixels_c[i] = 
-      RGBA(
-        pixels_c[i] & 0xFF, 
-        (pixels_c[i] >> 8) & 0xFF, 
-        (pixels_c[i] >> 16) & 0xFF, 
-        (pixels_c[i] >> 24) & 0xFF
-      );
+  size_t len = strlen(Path);
+  bool is_pfm = len >= 4 && strcmp(Path + len - 4, ".pfm") == 0;
+  FILE *F = fopen(Path, "wb");
 
-  stbi_write_png(Path, width, height, 4, pixels_c, 4 * width);
-  delete[] pixels_c;
+  if (F == nullptr)
+    return;
+  if (!is_pfm)
+    fwrite(hdr, sizeof(float) * 4, width * height, F);
+  else
+  {
+    float *row = new float[width * 3];
+
+    fprintf(F, "PF\n%d %d\n-1.0\n", width, height);
+    for (int y = height - 1; y >= 0; y--)
+    {
+      for (int x = 0; x < width; x++)
+        memcpy(row + x * 3, hdr + (y * width + x) * 4, 3 * sizeof(float));
+      fwrite(row, sizeof(float) * 3, width, F);
+    }
+    delete[] row;
+  }
+  fclose(F);
 }
 
 frame::~frame()
 {
   delete[] pixels;
+  delete[] hdr;
 }
 
 }
\ No newline at end of file
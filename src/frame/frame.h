@@ -16,11 +16,33 @@ class frame
 {
   friend class window;
   friend class scene;
+  friend class image_writer;
+public:
+  enum class tonemap { CLAMP, REINHARD, ACES };
+
+  /* Linear to display colors conversion settings */
+  struct develop_params
+  {
+    tonemap tone = tonemap::CLAMP; // Curve after exposure
+    float exposure = 1;            // Linear color scale
+    bool srgb = false;             // sRGB encode, otherwise bytes are linear
+  };
 private:
   int width, height;
   dword *pixels;
 
-  mutable std::recursive_mutex frame_mutex;
+  /* Linear colors, 4 floats (RGBA) per pixel. Display 'pixels' are
+   * developed from them, dword writes bypass this buffer. */
+  float *hdr;
+  develop_params develop;
+
+  /* Whole frame operations lock. Render threads write disjoint tiles
+   * without locking, so frame must not be resized while rendering. */
+  mutable std::mutex frame_mutex;
+
+  dword Develop( const float *Color ) const;
+
+  void Develop( int X0, int Y0, int W, int H );
 public:
   frame( int W, int H );
 
@@ -30,6 +52,16 @@ public:
 
   dword GetPixel( int X, int Y ) const;
 
+  void PutTile( int X0, int Y0, int W, int H, const dword *Tile );
+
+  void PutHdrTile( int X0, int Y0, int W, int H, const float *Tile );
+
+  void PutHdrRect( int X0, int Y0, int W, int H, float R, float G, float B );
+
+  void SetDevelop( const develop_params &Params );
+
+  const develop_params & GetDevelop( void ) const;
+
   void Clear( dword Color );
 
   void Clear( void );
@@ -37,6 +69,8 @@ public:
   static dword RGBA( byte R, byte G, byte B, byte A = 0xFF );
 
   void Save( const char *Path ) const;
+
+  void SaveHdr( const char *Path ) const;
   
   ~frame();
 };
@@ -0,0 +1,260 @@
+/* PROJECT     : tp5-rt
+ * FILE NAME   : writer.cpp
+ * PROGRAMMER  : Tim Peterson
+ * LAST UPDATE : 19.10.2026
+ * PURPOSE     : Background image writer methods defenition file.
+ * LICENSE     : MIT License
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <iostream>
+
+#include "writer.h"
+#include "lib/stb_image_write.h"
+
+/* Base developer namespace */
+namespace tp5
+{
+  /* stb writer settings are globals, so its calls go one at a time */
+  static std::mutex StbLock;
+
+  /* Encode RGBA bytes as QOI stream function.
+   * ARGUMENTS:
+   *   - pixels:
+   *       const byte *Px;
+   *   - image size:
+   *       int W, H;
+   *   - stream to fill:
+   *       stock<byte> &Out;
+   * RETURNS: None.
+   */
+  static void EncodeQoi( const byte *Px, int W, int H, stock<byte> &Out )
+  {
+    byte index[64][4] = {}, prev[4] = {0, 0, 0, 255};
+    int n = W * H, run = 0;
+    auto put = [&Out]( int B ){ Out.push_back((byte)B); };
+    auto put32 = [&put]( dword V ){ put(V >> 24), put(V >> 16), put(V >> 8), put(V); };
+
+    Out.clear();
+    Out.reserve(14 + n * 5 + 8);
+    put('q'), put('o'), put('i'), put('f');
+    put32(W), put32(H);
+    put(4), put(0);
+    for (int i = 0; i < n; i++)
+    {
+      const byte *p = Px + i * 4;
+
+      if (memcmp(p, prev, 4) == 0)
+      {
+        if (++run == 62 || i == n - 1)
+          put(0xC0 | (run - 1)), run = 0;
+        continue;
+      }
+      if (run > 0)
+        put(0xC0 | (run - 1)), run = 0;
+
+      int h = (p[0] * 3 + p[1] * 5 + p[2] * 7 + p[3] * 11) % 64;
+
+      if (memcmp(index[h], p, 4) == 0)
+        put(h);
+      else if (memcpy(index[h], p, 4), p[3] != prev[3])
+        put(0xFF), put(p[0]), put(p[1]), put(p[2]), put(p[3]);
+      else
+      {
+        signed char
+          dr = p[0] - prev[0], dg = p[1] - prev[1], db = p[2] - prev[2],
+          drg = dr - dg, dbg = db - dg;
+
+        if (dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 && db < 2)
+          put(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+        else if (drg > -9 && drg < 8 && dg > -33 && dg < 32 && dbg > -9 && dbg < 8)
+          put(0x80 | (dg + 32)), put((drg + 8) << 4 | (dbg + 8));
+        else
+          put(0xFE), put(p[0]), put(p[1]), put(p[2]);
+      }
+      memcpy(prev, p, 4);
+    }
+    for (int i = 0; i < 7; i++)
+      put(0);
+    put(1);
+  } /* End of 'EncodeQoi' function */
+
+  /* 'image_writer' constructor */
+  image_writer::image_writer( void )
+  {
+    Thread = std::thread(
+      [this]( void )
+      {
+        std::unique_lock<std::mutex> lk(Lock);
+
+        while (true)
+        {
+          IsChanged.wait(lk, [this]( void ){ return IsClosing || !Queue.empty(); });
+          if (Queue.empty())
+            return;
+
+          /* Front stays queued while it is saved, so 'Flush' waits for it */
+          const image &img = Queue.front();
+
+          lk.unlock();
+          if (!Save(img))
+            std::cerr << "Cannot write " << img.Path << std::endl;
+          lk.lock();
+          Queue.pop_front();
+          IsChanged.notify_all();
+        }
+      });
+  } /* End of 'image_writer::image_writer' function */
+
+  /* 'image_writer' destructor, saves queued images */
+  image_writer::~image_writer( void )
+  {
+    {
+      std::lock_guard<std::mutex> lg(Lock);
+
+      IsClosing = true;
+    }
+    IsChanged.notify_all();
+    Thread.join();
+  } /* End of 'image_writer::~image_writer' function */
+
+  /* File format by path extension function.
+   * ARGUMENTS:
+   *   - file name:
+   *       const std::string &Path;
+   * RETURNS:
+   *   (format) format, PNG for unknown extensions.
+   */
+  image_writer::format image_writer::FormatOf( const std::string &Path )
+  {
+    std::string ext = Path.substr(Path.find_last_of('.') + 1);
+
+    for (auto &c : ext)
+      c = tolower(c);
+    if (ext == "ppm")
+      return format::PPM;
+    if (ext == "qoi")
+      return format::QOI;
+    if (ext == "tga")
+      return format::TGA;
+    return format::PNG;
+  } /* End of 'image_writer::FormatOf' function */
+
+  /* Copy frame pixels function.
+   * ARGUMENTS:
+   *   - frame to copy:
+   *       const frame &Frm;
+   *   - file name:
+   *       const std::string &Path;
+   *   - PNG compression level:
+   *       int Level;
+   * RETURNS:
+   *   (image) snapshot.
+   */
+  image_writer::image image_writer::Snapshot( const frame &Frm, const std::string &Path, int Level )
+  {
+    const std::lock_guard<std::mutex> lock(Frm.frame_mutex);
+    image img;
+
+    img.W = Frm.width;
+    img.H = Frm.height;
+    img.Pixels.resize(img.W * img.H);
+    if (img.W * img.H > 0)
+      memcpy(img.Pixels.data(), Frm.pixels, img.W * img.H * sizeof(dword));
+    img.Path = Path;
+    img.Format = FormatOf(Path);
+    img.Level = Level;
+    return img;
+  } /* End of 'image_writer::Snapshot' function */
+
+  /* Encode and save image in calling thread function.
+   * ARGUMENTS:
+   *   - image to save:
+   *       const image &Img;
+   * RETURNS:
+   *   (bool) true if file is written.
+   */
+  bool image_writer::Save( const image &Img )
+  {
+    int n = Img.W * Img.H, ch = Img.Format == format::PPM ? 3 : 4;
+    stock<byte> px, out;
+
+    if (n == 0)
+      return false;
+
+    /* Packed 0xRRGGBBAA pixels to bytes in file order */
+    px.resize(n * ch);
+    for (int i = 0; i < n; i++)
+    {
+      dword p = Img.Pixels[i];
+      byte *d = &px[i * ch];
+
+      d[0] = p >> 24, d[1] = p >> 16, d[2] = p >> 8;
+      if (ch == 4)
+        d[3] = p;
+    }
+
+    if (Img.Format == format::PNG || Img.Format == format::TGA)
+    {
+      std::lock_guard<std::mutex> lg(StbLock);
+
+      if (Img.Format == format::TGA)
+      {
+        stbi_write_tga_with_rle = 0;
+        return stbi_write_tga(Img.Path.c_str(), Img.W, Img.H, 4, px.data()) != 0;
+      }
+      stbi_write_png_compression_level = Img.Level;
+      return stbi_write_png(Img.Path.c_str(), Img.W, Img.H, 4, px.data(), Img.W * 4) != 0;
+    }
+
+    FILE *F = fopen(Img.Path.c_str(), "wb");
+    bool is_ok;
+
+    if (F == nullptr)
+      return false;
+    if (Img.Format == format::PPM)
+      is_ok = fprintf(F, "P6\n%d %d\n255\n", Img.W, Img.H) > 0 && fwrite(px.data(), 1, px.size(), F) == px.size();
+    else
+    {
+      EncodeQoi(px.data(), Img.W, Img.H, out);
+      is_ok = fwrite(out.data(), 1, out.size(), F) == out.size();
+    }
+    return fclose(F) == 0 && is_ok;
+  } /* End of 'image_writer::Save' function */
+
+  /* Queue frame snapshot for saving function.
+   * ARGUMENTS:
+   *   - frame to save:
+   *       const frame &Frm;
+   *   - file name:
+   *       const std::string &Path;
+   * RETURNS: None.
+   */
+  void image_writer::Write( const frame &Frm, const std::string &Path )
+  {
+    image img = Snapshot(Frm, Path, PngLevel);
+
+    {
+      std::unique_lock<std::mutex> lk(Lock);
+
+      IsChanged.wait(lk, [this]( void ){ return (int)Queue.size() < std::max(MaxQueue, 1); });
+      Queue.push_back(std::move(img));
+    }
+    IsChanged.notify_all();
+  } /* End of 'image_writer::Write' function */
+
+  /* Wait for all queued images to be saved function.
+   * ARGUMENTS: None.
+   * RETURNS: None.
+   */
+  void image_writer::Flush( void )
+  {
+    std::unique_lock<std::mutex> lk(Lock);
+
+    IsChanged.wait(lk, [this]( void ){ return Queue.empty(); });
+  } /* End of 'image_writer::Flush' function */
+} /* end of 'tp5' namespace */
+
+/* END OF 'writer.cpp' FILE */
@@ -0,0 +1,119 @@
+/* PROJECT     : tp5-rt
+ * FILE NAME   : writer.h
+ * PROGRAMMER  : Tim Peterson
+ * LAST UPDATE : 19.10.2026
+ * PURPOSE     : Background image writer defenition file.
+ * LICENSE     : MIT License
+ */
+
+#ifndef __writer_h_
+#define __writer_h_
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "frame.h"
+
+/* Base developer namespace */
+namespace tp5
+{
+  /* Background image writer representation type.
+   * 'Write' only copies frame pixels, own thread encodes and saves the
+   * copy, so next frame can be rendered meanwhile. Format goes from path
+   * extension: PPM, QOI and TGA (uncompressed) are fast, PNG is small.
+   */
+  class image_writer
+  {
+  public:
+    /* Image file formats */
+    enum class format
+    {
+      PNG, // Deflate compressed, 'Level' sets speed and size
+      PPM, // Binary RGB, no alpha
+      QOI, // Quite OK image, fast lossless
+      TGA  // Uncompressed
+    }; /* End of 'format' enum */
+
+    /* Frame snapshot to save */
+    struct image
+    {
+      int W = 0, H = 0;    // Size in pixels
+      stock<dword> Pixels; // Frame pixels (as 'frame::RGBA' gives)
+      std::string Path;    // File name
+      format Format;       // File format
+      int Level;           // PNG compression level
+    }; /* End of 'image' structure */
+
+    int
+      PngLevel = 8, // PNG compression level (stb uses 5 at least)
+      MaxQueue = 4; // Queued images limit, 'Write' waits when it is reached
+
+  private:
+    std::thread Thread;                   // Encoding thread
+    std::mutex Lock;                      // Queue lock
+    std::condition_variable IsChanged;    // Queue changed condition
+    std::deque<image> Queue;              // Images to save, current one is front
+    bool IsClosing = false;               // Thread should exit flag
+
+  public:
+    /* 'image_writer' constructor */
+    image_writer( void );
+
+    /* 'image_writer' destructor, saves queued images */
+    ~image_writer( void );
+
+    /* File format by path extension function.
+     * ARGUMENTS:
+     *   - file name:
+     *       const std::string &Path;
+     * RETURNS:
+     *   (format) format, PNG for unknown extensions.
+     */
+    static format FormatOf( const std::string &Path );
+
+    /* Copy frame pixels function.
+     * ARGUMENTS:
+     *   - frame to copy:
+     *       const frame &Frm;
+     *   - file name:
+     *       const std::string &Path;
+     *   - PNG compression level:
+     *       int Level;
+     * RETURNS:
+     *   (image) snapshot.
+     */
+    static image Snapshot( const frame &Frm, const std::string &Path, int Level = 8 );
+
+    /* Encode and save image in calling thread function.
+     * ARGUMENTS:
+     *   - image to save:
+     *       const image &Img;
+     * RETURNS:
+     *   (bool) true if file is written.
+     */
+    static bool Save( const image &Img );
+
+    /* Queue frame snapshot for saving function.
+     * ARGUMENTS:
+     *   - frame to save:
+     *       const frame &Frm;
+     *   - file name:
+     *       const std::string &Path;
+     * RETURNS: None.
+     */
+    void Write( const frame &Frm, const std::string &Path );
+
+    /* Wait for all queued images to be saved function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    void Flush( void );
+  }; /* End of 'image_writer' class */
+} /* end of 'tp5' namespace */
+
+#endif /* __writer_h_ */
+
+/* END OF 'writer.h' FILE */
@@ -35,12 +35,10 @@ int main( void )
   
   MyWin.Run();
 
-  if (MyWin.Scene.IsRenderActive)
+  if (MyWin.Scene.Job.IsActive())
   {
-    MyWin.Scene.IsToBeStop = true;
     std::cout << "\nWait render thread finishing\n";
-    while (!MyWin.Scene.IsReadyToFinish)
-      ;
+    MyWin.Scene.Job.Stop();
     std::cout << "\nAfter waiting\n";
   }
   std::cout << "\nFinish\n";
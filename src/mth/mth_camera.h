@@ -61,6 +61,16 @@ namespace mth
         return ray(Loc + Q, Q);
       } /* End of 'FrameRay' function */
 
+      /* Get angle covered by one pixel at frame center function.
+       * ARGUMENTS: None.
+       * RETURNS:
+       *   (Type) angle in radians.
+       */
+      Type PixelAngle( void ) const
+      {
+        return Wp / FrameW / ProjDist;
+      } /* End of 'PixelAngle' function */
+
       /* camera default constructor */
       camera( void ) :
         Loc(0, 0, 5), Dir(0, 0, -1), Up(0, 1, 0), Right(1, 0, 0), At(0, 0, 0),
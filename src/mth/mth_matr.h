@@ -8,7 +8,7 @@
  *               4x4 matrix class math module.
  * PROGRAMMER  : CGSG-SummerCamp'2024.
  *               Timofei I. Petrov.
- * LAST UPDATE : 22.07.2024.
+ * LAST UPDATE : 19.10.2026.
  * NOTE        : None.
  *
  * No part of this file may be changed without agreement of
@@ -31,14 +31,10 @@ namespace mth
     {
     private:
       Type A[4][4];          // Matrix components array
-      mutable Type 
-        Inversed[4][4];      // Inversed matrix
-      mutable bool
-        IsInversedEvaluated; // If inversed matrix's been evaluated
 
     public:
       /* Default matr constructor */
-      matr( void ) : IsInversedEvaluated(false)
+      matr( void )
       {
       } /* End of default matr constructor */
 
@@ -61,7 +57,7 @@ namespace mth
             {A10, A11, A12, A13},
             {A20, A21, A22, A23},
             {A30, A31, A32, A33},
-          }, IsInversedEvaluated(false)
+          }
       {
       } /* End of 'matr' function */
 
@@ -70,9 +66,9 @@ namespace mth
        *   - array:
        *       Type Arr[4][4];
        */
-      matr( Type Arr[4][4] ) : IsInversedEvaluated(false)
+      matr( Type Arr[4][4] )
       {
-        std::memcpy(A, Arr, 16);
+        std::memcpy(A, Arr, 16 * sizeof(Type));
       } /* End of matr constructor */
 
       /* Get identity matrix function. 
@@ -361,22 +357,17 @@ namespace mth
        * ARGUMENTS: None.
        * RETURNS:
        *   (matr) inverse matrix.
+       * NOTE:
+       *   evaluated on every call (no hidden cache, so matrices can be
+       *   shared between render threads); keep the result if it's needed often.
        */
       matr Inverse( void ) const
       {
         Type det = !*this;
         matr r;
 
-        if (IsInversedEvaluated)
-          return matr(Inversed);
-        IsInversedEvaluated = true;
-
         if (det == 0)
-        {
-          r = Identity();
-          std::memcpy(Inversed, r.A[0], 16 * sizeof(Type));
-          return r;
-        }
+          return Identity();
  
         r.A[0][0] =
           +Determ3x3(A[1][1], A[1][2], A[1][3],
@@ -458,8 +449,6 @@ namespace mth
           +Determ3x3(A[0][0], A[0][1], A[0][2],
                      A[1][0], A[1][1], A[1][2],
                      A[2][0], A[2][1], A[2][2]) / det;
-        
-        std::memcpy(Inversed, r.A[0], 16 * sizeof(Type));
         return r;
       } /* End of 'Inverse' function */
 
@@ -607,9 +596,7 @@ namespace mth
        */
       vec3<Type> TransformNormal( const vec3<Type> &N ) const
       {
-        if (IsInversedEvaluated)
-          return matr(Inversed).Transpose().VectorTransform(N);
-        return (*this).Inverse().Transpose().VectorTransform(N);
+        return Inverse().Transpose().VectorTransform(N);
       } /* End of 'TransformNormal' function */
 
     }; /* End of 'matr' class */
@@ -0,0 +1,456 @@
+/*************************************************************
+ * Copyright (C) 2024
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : mth_rnd.h
+ * PURPOSE     : Raytracing project.
+ *               Random numbers and low discrepancy sampling math module.
+ * PROGRAMMER  : CGSG-SummerCamp'2024.
+ *               Timofei I. Petrov.
+ * LAST UPDATE : 19.10.2026.
+ * NOTE        : Generators are thread local, no locks are taken.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#ifndef __mth_rnd_h_
+#define __mth_rnd_h_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "mth_def.h"
+
+/* Math library namespace */
+namespace mth
+{
+  /* PCG32 random numbers generator representation type */
+  class rnd
+  {
+    uint64_t State, Inc; // Generator state and stream
+
+  public:
+    /* rnd constructor.
+     * ARGUMENTS:
+     *   - seed and stream number:
+     *       uint64_t Seed, Stream;
+     */
+    rnd( uint64_t Seed = 0x853C49E6748FEA9Bull, uint64_t Stream = 0xDA3E39CB94B95BDBull ) : State(0), Inc(Stream << 1 | 1)
+    {
+      Next();
+      State += Seed;
+      Next();
+    } /* End of 'rnd' function */
+
+    /* Get next 32 bit number function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (uint32_t) number.
+     */
+    uint32_t Next( void )
+    {
+      uint64_t old = State;
+      uint32_t x = (uint32_t)(((old >> 18) ^ old) >> 27), r = (uint32_t)(old >> 59);
+
+      State = old * 6364136223846793005ull + Inc;
+      return x >> r | x << ((32 - r) & 31);
+    } /* End of 'Next' function */
+
+    /* Get next uniform number function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (double) number in [0; 1).
+     */
+    double Get( void )
+    {
+      return Next() / 4294967296.0;
+    } /* End of 'Get' function */
+
+    /* Get calling thread generator function.
+     * Every thread gets own stream.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (rnd &) generator.
+     */
+    static rnd & Thread( void )
+    {
+      static std::atomic<uint64_t> Streams = 0;
+      thread_local rnd R(0x853C49E6748FEA9Bull, Streams++);
+
+      return R;
+    } /* End of 'Thread' function */
+  }; /* End of 'rnd' class */
+
+  /* Blue noise mask representation type.
+   * Tileable 64 x 64 threshold map made by void and cluster method
+   * (Ulichney 1993): every prefix of pixels by rank is evenly spread, so
+   * mask has almost no low frequencies. Mask is made once on first use.
+   */
+  class blue_noise
+  {
+  public:
+    static const int Size = 64; // Mask side (power of 2)
+
+  private:
+    float V[Size * Size]; // Thresholds in (0; 1)
+
+  public:
+    /* blue_noise constructor (makes mask) */
+    blue_noise( void )
+    {
+      const int n = Size * Size, m = n / 10;
+      const double sigma = 1.5;
+      std::vector<double> k(n), e(n, 0), e0;
+      std::vector<char> on(n, 0), on0;
+      std::vector<int> rank(n);
+      rnd r(2024);
+
+      /* Gaussian energy of one point on torus */
+      for (int y = 0; y < Size; y++)
+        for (int x = 0; x < Size; x++)
+        {
+          int dx = min(x, Size - x), dy = min(y, Size - y);
+
+          k[y * Size + x] = exp(-(dx * dx + dy * dy) / (2 * sigma * sigma));
+        }
+      auto toggle = [&]( int P, int S )
+      {
+        int px = P % Size, py = P / Size;
+
+        on[P] = S > 0;
+        for (int y = 0; y < Size; y++)
+          for (int x = 0; x < Size; x++)
+            e[y * Size + x] += S * k[((y - py) & (Size - 1)) * Size + ((x - px) & (Size - 1))];
+      };
+      /* Tightest cluster (max energy point) or largest void (min energy empty pixel) */
+      auto find = [&]( bool IsCluster )
+      {
+        int b = -1;
+
+        for (int i = 0; i < n; i++)
+          if (on[i] == IsCluster && (b == -1 || (IsCluster ? e[i] > e[b] : e[i] < e[b])))
+            b = i;
+        return b;
+      };
+
+      /* Random initial points, then move cluster points to voids until stable */
+      for (int c = 0; c < m; )
+        if (int p = (int)(r.Next() % n); !on[p])
+          toggle(p, 1), c++;
+      while (true)
+      {
+        int c = find(true);
+
+        toggle(c, -1);
+        int v = find(false);
+
+        toggle(v, 1);
+        if (v == c)
+          break;
+      }
+      on0 = on, e0 = e;
+
+      /* Initial points ranks: tightest cluster gets highest rank */
+      for (int c = m; c > 0; )
+      {
+        int p = find(true);
+
+        toggle(p, -1);
+        rank[p] = --c;
+      }
+
+      /* Rest ranks: largest void first */
+      on = on0, e = e0;
+      for (int c = m; c < n; c++)
+      {
+        int p = find(false);
+
+        toggle(p, 1);
+        rank[p] = c;
+      }
+      for (int i = 0; i < n; i++)
+        V[i] = (rank[i] + 0.5f) / n;
+    } /* End of 'blue_noise' function */
+
+    /* Get mask value function.
+     * ARGUMENTS:
+     *   - pixel coordinates (mask is tiled):
+     *       int X, Y;
+     * RETURNS:
+     *   (float) threshold in (0; 1).
+     */
+    float operator()( int X, int Y ) const
+    {
+      return V[(Y & (Size - 1)) * Size + (X & (Size - 1))];
+    } /* End of 'operator()' function */
+
+    /* Get shared mask function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (const blue_noise &) mask.
+     */
+    static const blue_noise & Get( void )
+    {
+      static const blue_noise B;
+
+      return B;
+    } /* End of 'Get' function */
+  }; /* End of 'blue_noise' class */
+
+  /* Low discrepancy sampler representation type.
+   * Sample is a point in many dimensional unit cube, 'Get' returns its
+   * next coordinate. Pixel number seeds Owen scrambling, so every pixel
+   * gets own well stratified sequence and neighbours are not correlated.
+   * Sobol dimensions go in groups of 4 with index shuffled per group
+   * (Burley 2020), Halton uses first 16 primes, then Sobol groups.
+   * Blue noise takes every dimension from shifted 'blue_noise' mask and
+   * adds R2 sequence step per sample, so error of pixels rendered with
+   * same sample number is spread to high frequencies.
+   * Not started sampler returns thread 'rnd' numbers.
+   */
+  class sampler
+  {
+  public:
+    /* Sequence kind */
+    enum class kind
+    {
+      RANDOM, // Thread random numbers
+      SOBOL,  // Owen scrambled Sobol sequence
+      HALTON, // Owen scrambled Halton sequence
+      BLUE    // Spatiotemporal blue noise masks (best for few samples per pixel)
+    }; /* End of 'kind' enumeration */
+
+  private:
+    kind Kind = kind::RANDOM; // Current sequence kind
+    uint32_t
+      Pixel = 0,              // Pixel coordinates (see 'Pack')
+      Seed = 0,               // Pixel scrambling seed
+      Index = 0,              // Sample number
+      Dim = 0;                // Next dimension
+
+    /* Integer hash function.
+     * ARGUMENTS:
+     *   - value:
+     *       uint32_t X;
+     * RETURNS:
+     *   (uint32_t) hash.
+     */
+    static uint32_t Hash( uint32_t X )
+    {
+      X ^= X >> 16, X *= 0x7FEB352Du, X ^= X >> 15, X *= 0x846CA68Bu, X ^= X >> 16;
+      return X;
+    } /* End of 'Hash' function */
+
+    /* Hash combine function.
+     * ARGUMENTS:
+     *   - hash and value to add:
+     *       uint32_t H, X;
+     * RETURNS:
+     *   (uint32_t) hash.
+     */
+    static uint32_t Hash( uint32_t H, uint32_t X )
+    {
+      return Hash(H ^ (X + 0x9E3779B9u + (H << 6) + (H >> 2)));
+    } /* End of 'Hash' function */
+
+    /* Reverse bits function.
+     * ARGUMENTS:
+     *   - value:
+     *       uint32_t X;
+     * RETURNS:
+     *   (uint32_t) reversed value.
+     */
+    static uint32_t Reverse( uint32_t X )
+    {
+      X = (X << 16) | (X >> 16);
+      X = ((X & 0x00FF00FFu) << 8) | ((X & 0xFF00FF00u) >> 8);
+      X = ((X & 0x0F0F0F0Fu) << 4) | ((X & 0xF0F0F0F0u) >> 4);
+      X = ((X & 0x33333333u) << 2) | ((X & 0xCCCCCCCCu) >> 2);
+      X = ((X & 0x55555555u) << 1) | ((X & 0xAAAAAAAAu) >> 1);
+      return X;
+    } /* End of 'Reverse' function */
+
+    /* Owen scramble of 32 bit fraction function.
+     * Hash based nested uniform scramble (Laine - Karras permutation).
+     * ARGUMENTS:
+     *   - fraction bits and seed:
+     *       uint32_t X, S;
+     * RETURNS:
+     *   (uint32_t) scrambled bits.
+     */
+    static uint32_t Owen( uint32_t X, uint32_t S )
+    {
+      X = Reverse(X);
+      X += S;
+      X ^= X * 0x6C50B47Cu;
+      X ^= X * 0xB82F1E52u;
+      X ^= X * 0xC7AFE638u;
+      X ^= X * 0x8D22F6E6u;
+      return Reverse(X);
+    } /* End of 'Owen' function */
+
+    /* Sobol point coordinate function.
+     * ARGUMENTS:
+     *   - point number:
+     *       uint32_t I;
+     *   - dimension (0 to 3):
+     *       int D;
+     * RETURNS:
+     *   (uint32_t) 32 bit fraction.
+     */
+    static uint32_t Sobol( uint32_t I, int D )
+    {
+      /* Direction numbers by Joe - Kuo primitive polynomials (degree, coefficients, initial numbers) */
+      struct matrices
+      {
+        uint32_t V[4][32];
+
+        matrices( void )
+        {
+          const int s[4] = {1, 1, 2, 3}, a[4] = {0, 0, 1, 1}, m[4][3] = {{1}, {1}, {1, 3}, {1, 3, 1}};
+
+          for (int k = 0; k < 32; k++)
+            V[0][k] = 1u << (31 - k);
+          for (int d = 1; d < 4; d++)
+            for (int k = 0; k < 32; k++)
+              if (k < s[d])
+                V[d][k] = (uint32_t)m[d][k] << (31 - k);
+              else
+              {
+                V[d][k] = V[d][k - s[d]] ^ (V[d][k - s[d]] >> s[d]);
+                for (int j = 1; j < s[d]; j++)
+                  if ((a[d] >> (s[d] - 1 - j)) & 1)
+                    V[d][k] ^= V[d][k - j];
+              }
+        }
+      };
+      static const matrices M;
+      uint32_t x = 0;
+
+      for (int k = 0; I != 0; I >>= 1, k++)
+        if (I & 1)
+          x ^= M.V[D][k];
+      return x;
+    } /* End of 'Sobol' function */
+
+    /* Owen scrambled radical inverse function.
+     * Every digit is shifted by hash of digits before it.
+     * ARGUMENTS:
+     *   - base:
+     *       uint32_t B;
+     *   - point number:
+     *       uint32_t I;
+     *   - seed:
+     *       uint32_t S;
+     * RETURNS:
+     *   (double) number in [0; 1).
+     */
+    static double Halton( uint32_t B, uint32_t I, uint32_t S )
+    {
+      double f = 1.0 / B, r = 0;
+
+      /* Zero digits are scrambled as well, until they fall below double precision */
+      for (double w = f; w > 1e-15; w *= f, I /= B)
+      {
+        uint32_t d = I % B;
+
+        r += (d + Hash(S) % B) % B * w;
+        S = Hash(S, d);
+      }
+      return r < 1 ? r : 0.99999999999999989;
+    } /* End of 'Halton' function */
+
+  public:
+    /* Pack pixel coordinates to pixel number function.
+     * ARGUMENTS:
+     *   - pixel coordinates (0 to 65535):
+     *       int X, Y;
+     * RETURNS:
+     *   (uint32_t) pixel number.
+     */
+    static uint32_t Pack( int X, int Y )
+    {
+      return ((uint32_t)X & 0xFFFF) | ((uint32_t)Y << 16);
+    } /* End of 'Pack' function */
+
+    /* Start sample function.
+     * ARGUMENTS:
+     *   - sequence kind:
+     *       kind K;
+     *   - pixel number (see 'Pack'):
+     *       uint32_t Pix;
+     *   - sample number in pixel:
+     *       uint32_t Sample;
+     *   - first dimension to take:
+     *       uint32_t FirstDim;
+     * RETURNS: None.
+     */
+    void Start( kind K, uint32_t Pix, uint32_t Sample, uint32_t FirstDim = 0 )
+    {
+      Kind = K;
+      Pixel = Pix;
+      Seed = Hash(Pix);
+      Index = Sample;
+      Dim = FirstDim;
+    } /* End of 'Start' function */
+
+    /* Stop sample function (thread random numbers are returned after).
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    void Stop( void )
+    {
+      Kind = kind::RANDOM;
+    } /* End of 'Stop' function */
+
+    /* Get next sample coordinate function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (double) number in [0; 1).
+     */
+    double Get( void )
+    {
+      static const uint32_t Primes[16] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53};
+      uint32_t d = Dim++;
+
+      if (Kind == kind::RANDOM)
+        return rnd::Thread().Get();
+      if (Kind == kind::HALTON && d < 16)
+        return Halton(Primes[d], Index, Hash(Seed, d));
+      if (Kind == kind::BLUE)
+      {
+        /* Pair of dimensions takes hashed mask shift, its second one half tile more */
+        uint32_t h = Hash(0xB1E5EEDu, d / 2), o = (d & 1) * blue_noise::Size / 2;
+        double v = blue_noise::Get()((Pixel & 0xFFFF) + (h & 0xFF) + o, (Pixel >> 16) + (h >> 8 & 0xFF) + o) +
+          Index * ((d & 1) ? 0.5698402909980532 : 0.7548776662466927);
+
+        return v - std::floor(v);
+      }
+
+      uint32_t gs = Hash(Seed, d / 4);
+
+      return Owen(Sobol(Owen(Index, gs), d % 4), Hash(gs, d % 4 + 1)) / 4294967296.0;
+    } /* End of 'Get' function */
+
+    /* Get calling thread sampler function.
+     * Renderer starts it for every primary ray, lights and materials take
+     * their numbers from it.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (sampler &) sampler.
+     */
+    static sampler & Thread( void )
+    {
+      thread_local sampler S;
+
+      return S;
+    } /* End of 'Thread' function */
+  }; /* End of 'sampler' class */
+} /* end of 'mth' namespace */
+
+#endif /* __mth_rnd_h_ */
+
+/* END OF 'mth_rnd.h' FILE */
@@ -0,0 +1,315 @@
+/*************************************************************
+ * Copyright (C) 2024
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : mth_simd.h
+ * PURPOSE     : Raytracing project.
+ *               4 wide float pack math module.
+ * PROGRAMMER  : CGSG-SummerCamp'2024.
+ *               Timofei I. Petrov.
+ * LAST UPDATE : 19.10.2026.
+ * NOTE        : SSE is used when available, plain arrays otherwise.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#ifndef __mth_simd_h_
+#define __mth_simd_h_
+
+#include "mth_def.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define MTH_SSE
+#include <immintrin.h>
+#endif /* __SSE2__ */
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif /* _MSC_VER */
+
+/* Math library namespace */
+namespace mth
+{
+  /* 4 wide float pack representation type.
+   * Comparisons give lane masks to be used with 'Select' and 'Mask'.
+   */
+  class simd4
+  {
+  public:
+#ifdef MTH_SSE
+    __m128 V; // Lanes
+
+    /* simd4 constructor by native value */
+    simd4( __m128 X ) : V(X)
+    {
+    } /* End of 'simd4' function */
+#else
+    float V[4]; // Lanes
+#endif /* MTH_SSE */
+
+    /* simd4 default constructor */
+    simd4( void ) : simd4(0.0f)
+    {
+    } /* End of 'simd4' function */
+
+    /* simd4 constructor by single value.
+     * ARGUMENTS:
+     *   - value for all lanes:
+     *       float X;
+     */
+    simd4( float X )
+    {
+#ifdef MTH_SSE
+      V = _mm_set1_ps(X);
+#else
+      V[0] = V[1] = V[2] = V[3] = X;
+#endif /* MTH_SSE */
+    } /* End of 'simd4' function */
+
+    /* Load 4 floats function.
+     * ARGUMENTS:
+     *   - source (no alignment needed):
+     *       const float *P;
+     * RETURNS:
+     *   (simd4) loaded pack.
+     */
+    static simd4 Load( const float *P )
+    {
+#ifdef MTH_SSE
+      return simd4(_mm_loadu_ps(P));
+#else
+      simd4 r;
+
+      for (int i = 0; i < 4; i++)
+        r.V[i] = P[i];
+      return r;
+#endif /* MTH_SSE */
+    } /* End of 'Load' function */
+
+    /* Store 4 floats function.
+     * ARGUMENTS:
+     *   - destination (no alignment needed):
+     *       float *P;
+     * RETURNS: None.
+     */
+    void Store( float *P ) const
+    {
+#ifdef MTH_SSE
+      _mm_storeu_ps(P, V);
+#else
+      for (int i = 0; i < 4; i++)
+        P[i] = V[i];
+#endif /* MTH_SSE */
+    } /* End of 'Store' function */
+
+#ifdef MTH_SSE
+#define MTH_SIMD4_OP(Op, Sse)                                        \
+    simd4 operator Op( const simd4 &B ) const                        \
+    {                                                                \
+      return simd4(Sse(V, B.V));                                     \
+    }
+#else
+#define MTH_SIMD4_OP(Op, Sse)                                        \
+    simd4 operator Op( const simd4 &B ) const                        \
+    {                                                                \
+      simd4 r;                                                       \
+      for (int i = 0; i < 4; i++)                                    \
+        r.V[i] = V[i] Op B.V[i];                                     \
+      return r;                                                      \
+    }
+#endif /* MTH_SSE */
+
+    /* Per lane arithmetic operator functions */
+    MTH_SIMD4_OP(+, _mm_add_ps)
+    MTH_SIMD4_OP(-, _mm_sub_ps)
+    MTH_SIMD4_OP(*, _mm_mul_ps)
+    MTH_SIMD4_OP(/, _mm_div_ps)
+#undef MTH_SIMD4_OP
+
+#ifdef MTH_SSE
+#define MTH_SIMD4_CMP(Op, Sse)                                       \
+    simd4 operator Op( const simd4 &B ) const                        \
+    {                                                                \
+      return simd4(Sse(V, B.V));                                     \
+    }
+#else
+#define MTH_SIMD4_CMP(Op, Sse)                                       \
+    simd4 operator Op( const simd4 &B ) const                        \
+    {                                                                \
+      simd4 r;                                                       \
+      for (int i = 0; i < 4; i++)                                    \
+        r.V[i] = V[i] Op B.V[i] ? 1.0f : 0.0f;                       \
+      return r;                                                      \
+    }
+#endif /* MTH_SSE */
+
+    /* Per lane compare operator functions (result is a lane mask) */
+    MTH_SIMD4_CMP(<, _mm_cmplt_ps)
+    MTH_SIMD4_CMP(>, _mm_cmpgt_ps)
+    MTH_SIMD4_CMP(<=, _mm_cmple_ps)
+    MTH_SIMD4_CMP(>=, _mm_cmpge_ps)
+#undef MTH_SIMD4_CMP
+
+    /* Lane masks conjunction function.
+     * ARGUMENTS:
+     *   - second mask:
+     *       const simd4 &B;
+     * RETURNS:
+     *   (simd4) result mask.
+     */
+    simd4 And( const simd4 &B ) const
+    {
+#ifdef MTH_SSE
+      return simd4(_mm_and_ps(V, B.V));
+#else
+      simd4 r;
+
+      for (int i = 0; i < 4; i++)
+        r.V[i] = V[i] != 0 && B.V[i] != 0 ? 1.0f : 0.0f;
+      return r;
+#endif /* MTH_SSE */
+    } /* End of 'And' function */
+
+    /* Get lane mask bits function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (int) bit per lane, lane 0 is the lowest.
+     */
+    int Mask( void ) const
+    {
+#ifdef MTH_SSE
+      return _mm_movemask_ps(V);
+#else
+      return (V[0] != 0) | (V[1] != 0) << 1 | (V[2] != 0) << 2 | (V[3] != 0) << 3;
+#endif /* MTH_SSE */
+    } /* End of 'Mask' function */
+
+    /* Get single lane function.
+     * ARGUMENTS:
+     *   - lane number:
+     *       int I;
+     * RETURNS:
+     *   (float) lane value.
+     */
+    float operator[]( int I ) const
+    {
+      float v[4];
+
+      Store(v);
+      return v[I];
+    } /* End of 'operator[]' function */
+
+    /* Per lane square root function.
+     * ARGUMENTS:
+     *   - pack:
+     *       const simd4 &A;
+     * RETURNS:
+     *   (simd4) result pack.
+     */
+    friend simd4 Sqrt( const simd4 &A )
+    {
+#ifdef MTH_SSE
+      return simd4(_mm_sqrt_ps(A.V));
+#else
+      simd4 r;
+
+      for (int i = 0; i < 4; i++)
+        r.V[i] = std::sqrt(A.V[i]);
+      return r;
+#endif /* MTH_SSE */
+    } /* End of 'Sqrt' function */
+
+    /* Per lane minimum function.
+     * ARGUMENTS:
+     *   - packs:
+     *       const simd4 &A, &B;
+     * RETURNS:
+     *   (simd4) result pack.
+     */
+    friend simd4 Min( const simd4 &A, const simd4 &B )
+    {
+#ifdef MTH_SSE
+      return simd4(_mm_min_ps(A.V, B.V));
+#else
+      simd4 r;
+
+      for (int i = 0; i < 4; i++)
+        r.V[i] = A.V[i] < B.V[i] ? A.V[i] : B.V[i];
+      return r;
+#endif /* MTH_SSE */
+    } /* End of 'Min' function */
+
+    /* Per lane maximum function.
+     * ARGUMENTS:
+     *   - packs:
+     *       const simd4 &A, &B;
+     * RETURNS:
+     *   (simd4) result pack.
+     */
+    friend simd4 Max( const simd4 &A, const simd4 &B )
+    {
+#ifdef MTH_SSE
+      return simd4(_mm_max_ps(A.V, B.V));
+#else
+      simd4 r;
+
+      for (int i = 0; i < 4; i++)
+        r.V[i] = A.V[i] > B.V[i] ? A.V[i] : B.V[i];
+      return r;
+#endif /* MTH_SSE */
+    } /* End of 'Max' function */
+
+    /* Per lane select by mask function.
+     * ARGUMENTS:
+     *   - lane mask:
+     *       const simd4 &M;
+     *   - values for set and cleared lanes:
+     *       const simd4 &A, &B;
+     * RETURNS:
+     *   (simd4) result pack.
+     */
+    friend simd4 Select( const simd4 &M, const simd4 &A, const simd4 &B )
+    {
+#ifdef MTH_SSE
+      return simd4(_mm_or_ps(_mm_and_ps(M.V, A.V), _mm_andnot_ps(M.V, B.V)));
+#else
+      simd4 r;
+
+      for (int i = 0; i < 4; i++)
+        r.V[i] = M.V[i] != 0 ? A.V[i] : B.V[i];
+      return r;
+#endif /* MTH_SSE */
+    } /* End of 'Select' function */
+  }; /* End of 'simd4' class */
+
+  /* Number of trailing zero bits function.
+   * ARGUMENTS:
+   *   - nonzero value (e.g. lane 'Mask'):
+   *       unsigned X;
+   * RETURNS:
+   *   (int) number of lowest zero bits.
+   */
+  inline int Ctz( unsigned X )
+  {
+#if defined(_MSC_VER)
+    unsigned long i;
+
+    _BitScanForward(&i, X);
+    return (int)i;
+#elif defined(__GNUC__)
+    return __builtin_ctz(X);
+#else
+    int i = 0;
+
+    while ((X & 1) == 0)
+      X >>= 1, i++;
+    return i;
+#endif /* _MSC_VER */
+  } /* End of 'Ctz' function */
+} /* end of 'mth' namespace */
+
+#endif /* __mth_simd_h_ */
+
+/* END OF 'mth_simd.h' FILE */
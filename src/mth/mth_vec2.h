@@ -19,6 +19,7 @@
 #define __mth_vec2_h_
 
 #include "mth_def.h"
+#include "mth_rnd.h"
 
 namespace mth
 {
@@ -320,7 +321,7 @@ namespace mth
        */
       static vec2<Type> Rnd0( void )
       {
-        return vec2<Type>(std::rand(), std::rand()) / Type(RAND_MAX);
+        return vec2<Type>(rnd::Thread().Get(), rnd::Thread().Get());
       }  /* End of 'Rnd0' function */
 
       /* Random vector in range -1 to 1 function.
@@ -330,7 +331,7 @@ namespace mth
        */
       static vec2<Type> Rnd1( void )
       {
-        return (vec2<Type>(std::rand(), std::rand()) / Type(RAND_MAX) - 0.5) * 2;
+        return (vec2<Type>(rnd::Thread().Get(), rnd::Thread().Get()) - 0.5) * 2;
       }  /* End of 'Rnd1' function */
     };
     /* Out put to stream operator for vec3 function
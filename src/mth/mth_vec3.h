@@ -19,6 +19,7 @@
 #define __mth_vec3_h_
 
 #include "mth_def.h"
+#include "mth_rnd.h"
 
 #include <iostream>
 
@@ -338,7 +339,7 @@ namespace mth
        */
       static vec3 Rnd0( void )
       {
-        return vec3(std::rand(), std::rand(), std::rand()) / Type(RAND_MAX);
+        return vec3(rnd::Thread().Get(), rnd::Thread().Get(), rnd::Thread().Get());
       }  /* End of 'Rnd0' function */
 
       /* Random vector in range -1 to 1 function.
@@ -348,7 +349,7 @@ namespace mth
        */
       static vec3 Rnd1( void )
       {
-        return (vec3(std::rand(), std::rand(), std::rand()) / Type(RAND_MAX) - vec3(0.5)) * 2;
+        return (vec3(rnd::Thread().Get(), rnd::Thread().Get(), rnd::Thread().Get()) - vec3(0.5)) * 2;
       }  /* End of 'Rnd1' function */
 
       /* Random normalized vector. */
@@ -366,7 +367,7 @@ namespace mth
         
         vec3 N         = Direction.Normalizing();
         vec3 proj      = r - (N * (N & r));
-        Type theta     = rand() / (Type)RAND_MAX * Angle;
+        Type theta     = rnd::Thread().Get() * Angle;
         vec3 new_dir   = matr<Type>().Rotate(theta, proj).VectorTransform(N);
 
         return new_dir;
@@ -388,6 +389,20 @@ namespace mth
         return r;
       } /* End of 'RndN' function */
 
+      /* Uniform unit sphere point by two uniform numbers function.
+       * ARGUMENTS:
+       *   - numbers in [0; 1):
+       *       Type U, V;
+       * RETURNS:
+       *   (vec3) unit vector.
+       */
+      static vec3 Sphere( Type U, Type V )
+      {
+        Type z = 1 - 2 * U, r = std::sqrt(1 - z * z > 0 ? 1 - z * z : 0), phi = Type(2 * PI) * V;
+
+        return vec3(r * std::cos(phi), r * std::sin(phi), z);
+      } /* End of 'Sphere' function */
+
       /* Reflect vector with respect to normal.
        * ARGUMENTS:
        *   - normal:
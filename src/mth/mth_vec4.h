@@ -19,6 +19,7 @@
 #define __mth_vec4_h_
 
 #include "mth_def.h"
+#include "mth_rnd.h"
 
 namespace mth
 {
@@ -328,7 +329,7 @@ namespace mth
        */
       static vec4<Type> Rnd0( void )
       {
-        return vec4<Type>(std::rand(), std::rand(), std::rand(), std::rand()) / Type(RAND_MAX);
+        return vec4<Type>(rnd::Thread().Get(), rnd::Thread().Get(), rnd::Thread().Get(), rnd::Thread().Get());
       }  /* End of 'Rnd0' function */
 
       /* Random vector in range -1 to 1 function.
@@ -338,7 +339,7 @@ namespace mth
        */
       static vec4<Type> Rnd1( void )
       {
-        return (vec4<Type>(std::rand(), std::rand(), std::rand(), std::rand()) / Type(RAND_MAX) - 0.5) * 2;
+        return (vec4<Type>(rnd::Thread().Get(), rnd::Thread().Get(), rnd::Thread().Get(), rnd::Thread().Get()) - 0.5) * 2;
       }  /* End of 'Rnd1' function */
     };
 
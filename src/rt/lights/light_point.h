@@ -46,7 +46,16 @@ namespace tp5
     double Shadow( const vec3 &P, light_info *L ) override
     {
       L->Color     = Color;
-      L->Direction = LightPoint - (P + vec3::RndN0() * Smooth);
+      if (Smooth > 0)
+      {
+        /* Two sample dimensions for point on light sphere */
+        sampler &smp = sampler::Thread();
+        real u = (real)smp.Get(), v = (real)smp.Get();
+
+        L->Direction = LightPoint - (P + vec3::Sphere(u, v) * Smooth);
+      }
+      else
+        L->Direction = LightPoint - P;
       L->Dist      = !L->Direction;
       L->Direction.Normalize();
       return 1.0 / (Cc + Cl * L->Dist + Cq * L->Dist * L->Dist);
@@ -0,0 +1,154 @@
+/* PROJECT     : tp5-rt
+ * FILE NAME   : rt_aa.cpp
+ * PROGRAMMER  : Tim Peterson
+ * LAST UPDATE : 19.10.2026
+ * PURPOSE     : 'scene' anti-aliasing methods defenition file.
+ * LICENSE     : MIT License
+ */
+
+#include <algorithm>
+
+#include "rt_scene.h"
+
+/* Get pixel stratified sample ray function.
+ * Sample I goes to stratum I, sampler only gives offset inside it, so
+ * strata hold for every sampling kind.
+ * ARGUMENTS:
+ *   - camera for rendering:
+ *       const camera &Cam;
+ *   - pixel coordinates:
+ *       int X, Y;
+ *   - sample number (0 - 15):
+ *       int I;
+ * RETURNS:
+ *   (ray) sample ray.
+ */
+tp5::ray tp5::scene::SampleRay( const camera &Cam, int X, int Y, int I ) const
+{
+  sampler smp;
+
+  smp.Start(Sampling, sampler::Pack(X, Y), I);
+  double u = smp.Get(), v = smp.Get();
+
+  return Cam.FrameRay(X + (I % 4 + u) / 4, Y + (I / 4 + v) / 4);
+} /* End of 'tp5::scene::SampleRay' function */
+
+/* Trace pixel with 4 x 4 stratified samples function.
+ * All samples fit one packet.
+ * ARGUMENTS:
+ *   - camera for rendering:
+ *       const camera &Cam;
+ *   - pixel coordinates:
+ *       int X, Y;
+ * RETURNS:
+ *   (vec3) mean color.
+ */
+tp5::vec3 tp5::scene::SuperSample( const camera &Cam, int X, int Y )
+{
+  const int n = 16;
+  uint32_t pix = sampler::Pack(X, Y);
+  ray_packet pk;
+  vec3 cs[ray_packet::Size], c = vec3(0);
+
+  for (int i = 0; i < n; i++)
+    pk.Add(SampleRay(Cam, X, Y, i), pix, i);
+  pk.Prepare(&Cam.Loc);
+  TracePacket(pk, cs);
+  for (int i = 0; i < pk.N; i++)
+    c += cs[i];
+  return c / pk.N;
+} /* End of 'tp5::scene::SuperSample' function */
+
+/* Trace pixels with 4 x 4 stratified samples by current integrator function.
+ * Wavefront mode traces samples of all pixels in one wave, pixel samples
+ * go in a row, so every packet holds one pixel.
+ * ARGUMENTS:
+ *   - camera for rendering:
+ *       const camera &Cam;
+ *   - pixels coordinates:
+ *       const stock<std::pair<int, int>> &Pixels;
+ *   - mean colors to fill:
+ *       stock<vec3> &Colors;
+ * RETURNS: None.
+ */
+void tp5::scene::SuperSample( const camera &Cam, const stock<std::pair<int, int>> &Pixels, stock<vec3> &Colors )
+{
+  const int n = 16;
+  int cnt = (int)Pixels.size();
+
+  if (Integrator != integrator::WAVEFRONT)
+  {
+    Colors.resize(cnt);
+    for (int i = 0; i < cnt; i++)
+      Colors[i] = SuperSample(Cam, Pixels[i].first, Pixels[i].second);
+    return;
+  }
+
+  stock<wave_ray> wave;
+
+  wave.reserve(cnt * n);
+  for (int i = 0; i < cnt; i++)
+    for (int k = 0; k < n; k++)
+      wave << wave_ray {SampleRay(Cam, Pixels[i].first, Pixels[i].second, k), vec3(1.0 / n), i, 0};
+  TraceWave(Cam, wave, cnt, Colors);
+} /* End of 'tp5::scene::SuperSample' function */
+
+/* Check if first pass pixel differs from its neighbours function.
+ * Pixels on both sides of an edge are marked, so edge gets same
+ * treatment as in uniform mode.
+ * ARGUMENTS:
+ *   - pixel coordinates:
+ *       int X, Y;
+ *   - frame size:
+ *       int W, H;
+ * RETURNS:
+ *   (bool) true if pixel lies on edge.
+ */
+bool tp5::scene::IsEdge( int X, int Y, int W, int H ) const
+{
+  const pixel_sample &p = Primary[Y * W + X];
+  auto clamp = []( const vec3 &C ){ return vec3(min(max(C.X, (real)0), (real)1), min(max(C.Y, (real)0), (real)1), min(max(C.Z, (real)0), (real)1)); };
+  vec3 pc = clamp(p.C);
+
+  for (int y = max(Y - 1, 0); y <= min(Y + 1, H - 1); y++)
+    for (int x = max(X - 1, 0); x <= min(X + 1, W - 1); x++)
+    {
+      const pixel_sample &q = Primary[y * W + x];
+      vec3 d = clamp(q.C) - pc;
+
+      if (q.Shp != p.Shp)
+        return true;
+      if (max(max(abs(d.X), abs(d.Y)), abs(d.Z)) > EdgeColor)
+        return true;
+      if (p.Shp != nullptr && abs(q.T - p.T) > EdgeDepth * min(q.T, p.T))
+        return true;
+    }
+  return false;
+} /* End of 'tp5::scene::IsEdge' function */
+
+/* Supersample edge pixels of tile function.
+ * ARGUMENTS:
+ *   - camera for rendering:
+ *       const camera &Cam;
+ *   - frame to render in:
+ *       frame &Frm;
+ *   - tile corner and size:
+ *       int X0, Y0, W, H;
+ * RETURNS: None.
+ */
+void tp5::scene::RefineTile( const camera &Cam, frame &Frm, int X0, int Y0, int W, int H )
+{
+  stock<std::pair<int, int>> pixels;
+  stock<vec3> colors;
+
+  for (int y = Y0; y < Y0 + H; y++)
+    for (int x = X0; x < X0 + W; x++)
+      if (IsEdge(x, y, Frm.width, Frm.height))
+        pixels.emplace_back(x, y);
+  SuperSample(Cam, pixels, colors);
+  for (int i = 0; i < (int)pixels.size(); i++)
+    Frm.PutHdrRect(pixels[i].first, pixels[i].second, 1, 1, (float)colors[i].X, (float)colors[i].Y, (float)colors[i].Z);
+  Refined += (int)pixels.size();
+} /* End of 'tp5::scene::RefineTile' function */
+
+/* END OF 'rt_aa.cpp' FILE */
@@ -0,0 +1,526 @@
+/* PROJECT     : tp5-rt
+ * FILE NAME   : rt_bvh.h
+ * PROGRAMMER  : Tim Peterson
+ * LAST UPDATE : 19.10.2026
+ * PURPOSE     : Bound volume hierarchy and triangle tests for shapes
+ *               with many primitives.
+ * LICENSE     : MIT License
+ */
+
+#ifndef __rt_bvh_h_
+#define __rt_bvh_h_
+
+#include <algorithm>
+#include <limits>
+
+#include "rt/rt_def.h"
+
+/* Base project namespace */
+namespace tp5
+{
+  /* Float vector type for compact primitive storage */
+  typedef mth::vec3<float> fvec3;
+
+  /* Axis aligned bound box representation type */
+  struct aabb
+  {
+    fvec3 B0, B1; // Min and max corners
+
+    /* 'aabb' default constructor (empty box) */
+    aabb( void ) :
+      B0(std::numeric_limits<float>::max()), B1(-std::numeric_limits<float>::max())
+    {
+    } /* End of 'aabb' function */
+
+    /* 'aabb' constructor by corners.
+     * ARGUMENTS:
+     *   - corners:
+     *       const fvec3 &Min, &Max;
+     */
+    aabb( const fvec3 &Min, const fvec3 &Max ) : B0(Min), B1(Max)
+    {
+    } /* End of 'aabb' function */
+
+    /* Grow box by another box function.
+     * ARGUMENTS:
+     *   - box to include:
+     *       const aabb &B;
+     * RETURNS:
+     *   (aabb &) self reference.
+     */
+    aabb & operator<<( const aabb &B )
+    {
+      B0 = fvec3(std::min(B0.X, B.B0.X), std::min(B0.Y, B.B0.Y), std::min(B0.Z, B.B0.Z));
+      B1 = fvec3(std::max(B1.X, B.B1.X), std::max(B1.Y, B.B1.Y), std::max(B1.Z, B.B1.Z));
+      return *this;
+    } /* End of 'operator<<' function */
+
+    /* Grow box by point function.
+     * ARGUMENTS:
+     *   - point to include:
+     *       const fvec3 &P;
+     * RETURNS:
+     *   (aabb &) self reference.
+     */
+    aabb & operator<<( const fvec3 &P )
+    {
+      return *this << aabb(P, P);
+    } /* End of 'operator<<' function */
+
+    /* Get box center function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (fvec3) center.
+     */
+    fvec3 Center( void ) const
+    {
+      return (B0 + B1) * 0.5f;
+    } /* End of 'Center' function */
+
+    /* Get half of surface area function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (float) half area (0 for empty box).
+     */
+    float Area( void ) const
+    {
+      fvec3 e = B1 - B0;
+
+      if (e.X < 0)
+        return 0;
+      return e.X * e.Y + e.Y * e.Z + e.Z * e.X;
+    } /* End of 'Area' function */
+
+    /* Get box corners as double vectors function.
+     * ARGUMENTS:
+     *   - corners to fill:
+     *       vec3 &Min, &Max;
+     * RETURNS:
+     *   (bool) false for empty box.
+     */
+    bool Get( vec3 &Min, vec3 &Max ) const
+    {
+      if (B0.X > B1.X)
+        return false;
+      Min = vec3(B0.X, B0.Y, B0.Z);
+      Max = vec3(B1.X, B1.Y, B1.Z);
+      return true;
+    } /* End of 'Get' function */
+  }; /* End of 'aabb' structure */
+
+  /* Ray prepared for box tests representation type */
+  struct bvh_ray
+  {
+    float O[3], InvD[3]; // Origin and inverse direction
+
+    /* 'bvh_ray' constructor by ray.
+     * ARGUMENTS:
+     *   - ray:
+     *       const ray &R;
+     */
+    bvh_ray( const ray &R )
+    {
+      for (int i = 0; i < 3; i++)
+      {
+        O[i] = (float)R.Org[i];
+        InvD[i] = R.Dir[i] != 0 ? (float)(1 / R.Dir[i]) : std::numeric_limits<float>::max();
+      }
+    } /* End of 'bvh_ray' function */
+  }; /* End of 'bvh_ray' structure */
+
+  /* Flat bound volume hierarchy representation type.
+   * Built with binned SAH over primitive bounds given by a callback.
+   * After building 'Index' holds primitive order: shapes reorder their
+   * own arrays by it so every leaf is a contiguous range.
+   */
+  class bvh
+  {
+  public:
+    /* Tree node (32 bytes) */
+    struct node
+    {
+      float B0[3];  // Bound box min
+      int   First;  // Leaf: first primitive; inner: left child (right is next)
+      float B1[3];  // Bound box max
+      int   Count;  // Leaf: primitives count; inner: 0
+
+      /* Ray/box test function.
+       * ARGUMENTS:
+       *   - prepared ray:
+       *       const bvh_ray &R;
+       *   - max distance:
+       *       float TMax;
+       *   - entry distance:
+       *       float &TNear;
+       * RETURNS:
+       *   (bool) true if box is hit closer than TMax.
+       */
+      bool Hit( const bvh_ray &R, float TMax, float &TNear ) const
+      {
+        float t0 = 0, t1 = TMax;
+
+        for (int i = 0; i < 3; i++)
+        {
+          float
+            ta = (B0[i] - R.O[i]) * R.InvD[i],
+            tb = (B1[i] - R.O[i]) * R.InvD[i];
+
+          if (ta > tb)
+            std::swap(ta, tb);
+          t0 = ta > t0 ? ta : t0;
+          t1 = tb < t1 ? tb : t1;
+        }
+        TNear = t0;
+        return t0 <= t1;
+      } /* End of 'Hit' function */
+    }; /* End of 'node' structure */
+
+    stock<node> Nodes; // Nodes, root is the first
+    stock<int>  Index; // Primitives order after build
+
+    /* Build hierarchy function.
+     * ARGUMENTS:
+     *   - number of primitives:
+     *       int N;
+     *   - primitive bound box getter, aabb (int I):
+     *       BoundFunc Bound;
+     *   - max primitives in leaf:
+     *       int LeafSize;
+     * RETURNS: None.
+     */
+    template<class BoundFunc>
+      void Build( int N, BoundFunc Bound, int LeafSize = 4 )
+      {
+        const int bins = 16;
+        struct task
+        {
+          int Node, Start, Count, Depth;
+        };
+        struct ref
+        {
+          aabb B; // Primitive box
+          int  I; // Primitive number
+        };
+        stock<task> stack;
+        stock<ref> refs;
+
+        Nodes.clear();
+        Index.clear();
+        if (N == 0)
+          return;
+
+        /* Boxes are evaluated once and moved along with indices,
+         * so all passes below read memory sequentially */
+        refs.resize(N);
+        for (int i = 0; i < N; i++)
+          refs[i] = ref {Bound(i), i};
+        Nodes.reserve(2 * (N / LeafSize + 1));
+        Nodes << node {};
+        stack << task {0, 0, N, 0};
+
+        while (!stack.empty())
+        {
+          task tk = stack.back();
+          aabb box, cbox;
+
+          stack.pop_back();
+          for (int i = tk.Start; i < tk.Start + tk.Count; i++)
+          {
+            box << refs[i].B;
+            cbox << refs[i].B.Center();
+          }
+          SetBox(Nodes[tk.Node], box);
+          Nodes[tk.Node].First = tk.Start;
+          Nodes[tk.Node].Count = tk.Count;
+          if (tk.Count <= LeafSize)
+            continue;
+
+          /* Pick split axis and bin primitives by centroids */
+          fvec3 ext = cbox.B1 - cbox.B0;
+          int axis = ext.X > ext.Y ? (ext.X > ext.Z ? 0 : 2) : (ext.Y > ext.Z ? 1 : 2);
+          float lo = cbox.B0[axis], scale = ext[axis] > 0 ? bins / ext[axis] : 0;
+          int split = -1;
+
+          /* Deep nodes are split by count to bound traversal stack */
+          if (scale > 0 && tk.Depth < 40)
+          {
+            aabb bb[bins];
+            int bc[bins] = {};
+            float cost = std::numeric_limits<float>::max();
+
+            for (int i = tk.Start; i < tk.Start + tk.Count; i++)
+            {
+              int k = std::min(bins - 1, (int)((refs[i].B.Center()[axis] - lo) * scale));
+
+              bb[k] << refs[i].B;
+              bc[k]++;
+            }
+
+            /* Sweep from the right, then from the left evaluating SAH */
+            float rarea[bins];
+            int rcount[bins];
+            aabb acc;
+            int cnt = 0;
+
+            for (int k = bins - 1; k > 0; k--)
+            {
+              acc << bb[k];
+              cnt += bc[k];
+              rarea[k] = acc.Area();
+              rcount[k] = cnt;
+            }
+            acc = aabb();
+            cnt = 0;
+            for (int k = 0; k < bins - 1; k++)
+            {
+              acc << bb[k];
+              cnt += bc[k];
+              if (cnt == 0 || rcount[k + 1] == 0)
+                continue;
+
+              float c = acc.Area() * cnt + rarea[k + 1] * rcount[k + 1];
+
+              if (c < cost)
+                cost = c, split = k;
+            }
+            /* Keep as leaf if splitting is not worth it */
+            if (split != -1 && cost >= box.Area() * tk.Count && tk.Count <= 2 * LeafSize)
+              continue;
+          }
+
+          ref *first = refs.data() + tk.Start, *last = first + tk.Count, *mid;
+
+          if (split != -1)
+            mid = std::partition(first, last,
+              [&]( const ref &R )
+              {
+                return std::min(bins - 1, (int)((R.B.Center()[axis] - lo) * scale)) <= split;
+              });
+          else
+          {
+            /* All centroids coincide: split by count */
+            mid = first + tk.Count / 2;
+          }
+          int nl = (int)(mid - first);
+
+          if (nl == 0 || nl == tk.Count)
+            nl = tk.Count / 2;
+
+          int left = (int)Nodes.size();
+
+          Nodes << node {} << node {};
+          Nodes[tk.Node].First = left;
+          Nodes[tk.Node].Count = 0;
+          stack << task {left, tk.Start, nl, tk.Depth + 1} << task {left + 1, tk.Start + nl, tk.Count - nl, tk.Depth + 1};
+        }
+        Nodes.shrink_to_fit();
+        Index.resize(N);
+        for (int i = 0; i < N; i++)
+          Index[i] = refs[i].I;
+      } /* End of 'Build' function */
+
+    /* Reorder primitive array by build order function.
+     * ARGUMENTS:
+     *   - array to reorder:
+     *       stock<Type> &A;
+     * RETURNS: None.
+     */
+    template<typename Type>
+      void Reorder( stock<Type> &A ) const
+      {
+        stock<Type> tmp;
+
+        tmp.resize(A.size());
+        for (size_t i = 0; i < Index.size(); i++)
+          tmp[i] = A[Index[i]];
+        A.swap(tmp);
+      } /* End of 'Reorder' function */
+
+    /* Find closest intersection function.
+     * ARGUMENTS:
+     *   - ray:
+     *       const ray &R;
+     *   - max distance (updated by leaf callback):
+     *       double &TMax;
+     *   - leaf test, bool (int First, int Count, double &TMax),
+     *     returns true and shrinks TMax on closer hit:
+     *       LeafFunc Leaf;
+     * RETURNS:
+     *   (bool) true if any leaf reported a hit.
+     */
+    template<class LeafFunc>
+      bool Traverse( const ray &R, double &TMax, LeafFunc Leaf ) const
+      {
+        bvh_ray br(R);
+        int stack[128], sp = 0, n = 0;
+        bool hit = false;
+        float tn;
+
+        if (Nodes.empty() || !Nodes[0].Hit(br, (float)TMax, tn))
+          return false;
+        while (true)
+        {
+          const node &nd = Nodes[n];
+
+          if (nd.Count > 0)
+          {
+            hit |= Leaf(nd.First, nd.Count, TMax);
+            if (sp == 0)
+              break;
+            n = stack[--sp];
+            continue;
+          }
+
+          /* Visit closer child first */
+          float ta, tb;
+          bool
+            ha = Nodes[nd.First].Hit(br, (float)TMax, ta),
+            hb = Nodes[nd.First + 1].Hit(br, (float)TMax, tb);
+
+          if (ha && hb)
+          {
+            if (tb < ta)
+              n = nd.First + 1, stack[sp++] = nd.First;
+            else
+              n = nd.First, stack[sp++] = nd.First + 1;
+          }
+          else if (ha)
+            n = nd.First;
+          else if (hb)
+            n = nd.First + 1;
+          else if (sp == 0)
+            break;
+          else
+            n = stack[--sp];
+        }
+        return hit;
+      } /* End of 'Traverse' function */
+
+    /* Visit all leaves overlapped by ray segment function.
+     * ARGUMENTS:
+     *   - ray:
+     *       const ray &R;
+     *   - segment end distance:
+     *       double TMax;
+     *   - leaf visitor, void (int First, int Count):
+     *       LeafFunc Leaf;
+     * RETURNS: None.
+     */
+    template<class LeafFunc>
+      void Walk( const ray &R, double TMax, LeafFunc Leaf ) const
+      {
+        bvh_ray br(R);
+        int stack[128], sp = 0;
+        float tn;
+
+        if (Nodes.empty())
+          return;
+        stack[sp++] = 0;
+        while (sp > 0)
+        {
+          const node &nd = Nodes[stack[--sp]];
+
+          if (!nd.Hit(br, (float)TMax, tn))
+            continue;
+          if (nd.Count > 0)
+            Leaf(nd.First, nd.Count);
+          else
+            stack[sp++] = nd.First + 1, stack[sp++] = nd.First;
+        }
+      } /* End of 'Walk' function */
+
+    /* Get whole hierarchy bound box function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (aabb) root box.
+     */
+    aabb Bound( void ) const
+    {
+      if (Nodes.empty())
+        return aabb();
+      return aabb(fvec3(Nodes[0].B0[0], Nodes[0].B0[1], Nodes[0].B0[2]),
+                  fvec3(Nodes[0].B1[0], Nodes[0].B1[1], Nodes[0].B1[2]));
+    } /* End of 'Bound' function */
+
+  private:
+    /* Store box to node function.
+     * ARGUMENTS:
+     *   - node:
+     *       node &Nd;
+     *   - box:
+     *       const aabb &B;
+     * RETURNS: None.
+     */
+    static void SetBox( node &Nd, const aabb &B )
+    {
+      for (int i = 0; i < 3; i++)
+        Nd.B0[i] = B.B0[i], Nd.B1[i] = B.B1[i];
+    } /* End of 'SetBox' function */
+  }; /* End of 'bvh' class */
+
+  /* Ray - triangle intersection function.
+   * ARGUMENTS:
+   *   - triangle vertices:
+   *       const fvec3 &A, &B, &C;
+   *   - ray:
+   *       const ray &R;
+   *   - barycentric coordinates to fill:
+   *       double &U, &V;
+   * RETURNS:
+   *   (double) distance, -1 if no intersection.
+   */
+  inline double TriIntersect( const fvec3 &A, const fvec3 &B, const fvec3 &C, const ray &R, double &U, double &V )
+  {
+    vec3
+      p0(A.X, A.Y, A.Z),
+      e1 = vec3(B.X, B.Y, B.Z) - p0,
+      e2 = vec3(C.X, C.Y, C.Z) - p0,
+      pv = R.Dir % e2;
+    double det = e1 & pv;
+
+    if (std::abs(det) < 1e-18)
+      return -1;
+
+    vec3 tv = R.Org - p0, qv = tv % e1;
+
+    U = (tv & pv) / det, V = (R.Dir & qv) / det;
+    if (U < 0 || V < 0 || U + V > 1)
+      return -1;
+    return (e2 & qv) / det;
+  } /* End of 'TriIntersect' function */
+
+  /* Interpolated triangle normal at point function.
+   * ARGUMENTS:
+   *   - triangle vertices:
+   *       const fvec3 &A, &B, &C;
+   *   - vertex normals:
+   *       const fvec3 &NA, &NB, &NC;
+   *   - point on triangle:
+   *       const vec3 &P;
+   * RETURNS:
+   *   (vec3) unit normal, geometric one if vertex normals cancel out.
+   */
+  inline vec3 TriNormal( const fvec3 &A, const fvec3 &B, const fvec3 &C,
+                         const fvec3 &NA, const fvec3 &NB, const fvec3 &NC, const vec3 &P )
+  {
+    auto d = []( const fvec3 &V ){ return vec3(V.X, V.Y, V.Z); };
+    vec3
+      a = d(A),
+      e1 = d(B) - a,
+      e2 = d(C) - a,
+      h = P - a;
+    double
+      d11 = e1 & e1, d12 = e1 & e2, d22 = e2 & e2,
+      h1 = h & e1, h2 = h & e2,
+      den = d11 * d22 - d12 * d12,
+      u = den != 0 ? (d22 * h1 - d12 * h2) / den : 1 / 3.0,
+      v = den != 0 ? (d11 * h2 - d12 * h1) / den : 1 / 3.0;
+    vec3 n = d(NA) * (1 - u - v) + d(NB) * u + d(NC) * v;
+
+    return (n & n) > 0 ? n.Normalizing() : (e1 % e2).Normalizing();
+  } /* End of 'TriNormal' function */
+} /* end of 'tp5' namespace */
+
+#endif /* __rt_bvh_h_ */
+
+/* END OF 'rt_bvh.h' FILE */
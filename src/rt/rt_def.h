@@ -9,7 +9,9 @@
 #ifndef __rt_def_h_
 #define __rt_def_h_
 
+#include <algorithm>
 #include <functional>
+#include <limits>
 
 #include "def.h"
 #include "mods/mods.h"
@@ -17,8 +19,8 @@
 /* Base project namespace */
 namespace tp5
 {
-  /* distance trashold */
-  const double Trashold = 0.001;
+  /* distance trashold, kept at least 10^4 units in last place of unit coordinates */
+  const real Trashold = std::max(0.001, 1e4 * std::numeric_limits<real>::epsilon());
 
   /* Forwrd declaration of shape class */
   class shape;
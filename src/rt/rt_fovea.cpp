@@ -0,0 +1,84 @@
+/* PROJECT     : tp5-rt
+ * FILE NAME   : rt_fovea.cpp
+ * PROGRAMMER  : Tim Peterson
+ * LAST UPDATE : 19.10.2026
+ * PURPOSE     : 'scene' foveated rendering methods defenition file.
+ * LICENSE     : MIT License
+ */
+
+#include <algorithm>
+
+#include "rt_scene.h"
+
+/* Render frame tile by sparse samples and bilinear upsampling function.
+ * Samples lie on lattice with given step plus last row and column of
+ * tile, so every pixel is interpolated between samples of its own tile.
+ * ARGUMENTS:
+ *   - camera for rendering:
+ *       const camera &Cam;
+ *   - frame to render in:
+ *       frame &Frm;
+ *   - tile corner and size:
+ *       int X0, Y0, W, H;
+ *   - distance between samples in pixels:
+ *       int Step;
+ * RETURNS: None.
+ */
+void tp5::scene::FoveaTile( const camera &Cam, frame &Frm, int X0, int Y0, int W, int H, int Step )
+{
+  stock<int> xs, ys;
+  stock<vec3> cs;
+  stock<float> px;
+
+  for (int x = 0; x < W - 1; x += Step)
+    xs << x;
+  xs << W - 1;
+  for (int y = 0; y < H - 1; y += Step)
+    ys << y;
+  ys << H - 1;
+
+  int nx = (int)xs.size(), ny = (int)ys.size(), n = nx * ny;
+
+  cs.resize(n);
+  px.resize(W * H * 4);
+  for (int i = 0; i < n; i += ray_packet::Size)
+  {
+    ray_packet pk;
+
+    for (int k = i; k < min(i + ray_packet::Size, n); k++)
+      pk << Cam.FrameRay(X0 + xs[k % nx] + 0.5, Y0 + ys[k / nx] + 0.5);
+    pk.Prepare(&Cam.Loc);
+    TracePacket(pk, &cs[i]);
+  }
+
+  /* Lattice cell of pixel and its weights */
+  auto cell = [Step]( const stock<int> &Ps, int P, int &I0, int &I1, real &T )
+  {
+    I0 = min(P / Step, (int)Ps.size() - 1);
+    I1 = min(I0 + 1, (int)Ps.size() - 1);
+    T = I1 == I0 ? 0 : (real)(P - Ps[I0]) / (Ps[I1] - Ps[I0]);
+  };
+
+  for (int y = 0; y < H; y++)
+  {
+    int j0, j1;
+    real ty;
+
+    cell(ys, y, j0, j1, ty);
+    for (int x = 0; x < W; x++)
+    {
+      int i0, i1;
+      real tx;
+
+      cell(xs, x, i0, i1, tx);
+      vec3
+        c0 = cs[j0 * nx + i0] * (1 - tx) + cs[j0 * nx + i1] * tx,
+        c1 = cs[j1 * nx + i0] * (1 - tx) + cs[j1 * nx + i1] * tx;
+
+      ToHdr(c0 * (1 - ty) + c1 * ty, &px[(y * W + x) * 4]);
+    }
+  }
+  Frm.PutHdrTile(X0, Y0, W, H, px.data());
+} /* End of 'tp5::scene::FoveaTile' function */
+
+/* END OF 'rt_fovea.cpp' FILE */
@@ -0,0 +1,140 @@
+/* PROJECT     : tp5-rt
+ * FILE NAME   : rt_job.h
+ * PROGRAMMER  : Tim Peterson
+ * LAST UPDATE : 19.10.2026
+ * PURPOSE     : Render job handle with cooperative cancellation.
+ * LICENSE     : MIT License
+ */
+
+#ifndef __rt_job_h_
+#define __rt_job_h_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+/* Base project namespace */
+namespace tp5
+{
+  /* Render job handle representation type.
+   * Cancellation is a token: renderer checks it before every tile, so
+   * job stops at most one tile after 'Cancel'. Waiting sleeps on
+   * condition variable until renderer calls 'Finish'.
+   */
+  class render_job
+  {
+    mutable std::mutex Lock;           // State lock
+    std::condition_variable IsStopped; // Job finished condition
+    bool IsRunning = false;            // Job is running flag
+    std::atomic_bool IsCancel = false; // Cancellation token
+
+  public:
+    /* Mark job started function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (bool) true if started, false if job is already running.
+     */
+    bool Start( void )
+    {
+      std::lock_guard<std::mutex> lg(Lock);
+
+      if (IsRunning)
+        return false;
+      IsRunning = true;
+      IsCancel = false;
+      return true;
+    } /* End of 'Start' function */
+
+    /* Mark job finished and wake waiters function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    void Finish( void )
+    {
+      {
+        std::lock_guard<std::mutex> lg(Lock);
+
+        IsRunning = false;
+        IsCancel = false;
+      }
+      IsStopped.notify_all();
+    } /* End of 'Finish' function */
+
+    /* Request job cancellation function (no effect on idle job).
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    void Cancel( void )
+    {
+      std::lock_guard<std::mutex> lg(Lock);
+
+      if (IsRunning)
+        IsCancel = true;
+    } /* End of 'Cancel' function */
+
+    /* Check cancellation token function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (bool) true if job should stop.
+     */
+    bool IsCanceled( void ) const
+    {
+      return IsCancel;
+    } /* End of 'IsCanceled' function */
+
+    /* Check if job is running function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (bool) true if running.
+     */
+    bool IsActive( void ) const
+    {
+      std::lock_guard<std::mutex> lg(Lock);
+
+      return IsRunning;
+    } /* End of 'IsActive' function */
+
+    /* Wait for job end function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    void Wait( void )
+    {
+      std::unique_lock<std::mutex> lk(Lock);
+
+      IsStopped.wait(lk, [this]( void ){ return !IsRunning; });
+    } /* End of 'Wait' function */
+
+    /* Wait for job end with timeout function.
+     * ARGUMENTS:
+     *   - timeout in milliseconds:
+     *       double Ms;
+     * RETURNS:
+     *   (bool) true if job is not running.
+     */
+    bool WaitFor( double Ms )
+    {
+      std::unique_lock<std::mutex> lk(Lock);
+
+      return IsStopped.wait_for(lk, std::chrono::duration<double, std::milli>(Ms), [this]( void ){ return !IsRunning; });
+    } /* End of 'WaitFor' function */
+
+    /* Cancel job and wait for its end function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    void Stop( void )
+    {
+      std::unique_lock<std::mutex> lk(Lock);
+
+      if (IsRunning)
+        IsCancel = true;
+      IsStopped.wait(lk, [this]( void ){ return !IsRunning; });
+    } /* End of 'Stop' function */
+  }; /* End of 'render_job' class */
+} /* end of 'tp5' namespace */
+
+#endif /* __rt_job_h_ */
+
+/* END OF 'rt_job.h' FILE */
@@ -0,0 +1,196 @@
+/* PROJECT     : tp5-rt
+ * FILE NAME   : rt_packet.h
+ * PROGRAMMER  : Tim Peterson
+ * LAST UPDATE : 19.10.2026
+ * PURPOSE     : Coherent rays packet for primary visibility.
+ * LICENSE     : MIT License
+ */
+
+#ifndef __rt_packet_h_
+#define __rt_packet_h_
+
+#include <cmath>
+
+#include "mth/mth_simd.h"
+#include "rt/rt_bvh.h"
+
+/* Base project namespace */
+namespace tp5
+{
+  /* Coherent rays bundle representation type.
+   * Rays are kept as is for exact tests and as float SoA for 4 wide box and
+   * rejection tests. When all rays go through one point (camera location)
+   * packet also gets bounding frustum, box outside it is rejected at once.
+   * Lanes past 'N' have negative 'TMax', so they never hit anything.
+   */
+  struct ray_packet
+  {
+    static const int Size = 16; // Max rays in packet
+
+    int N = 0;                           // Number of rays
+    ray R[Size];                         // Rays
+    alignas(16) float
+      OX[Size], OY[Size], OZ[Size],      // Origins
+      DX[Size], DY[Size], DZ[Size],      // Directions
+      IX[Size], IY[Size], IZ[Size],      // Inverse directions
+      TMax[Size];                        // Closest hit distances found so far
+    vec3 Mean;                           // Mean direction
+    bool IsFrustum = false;              // Frustum is valid flag
+    vec3 Apex, FN[4];                    // Frustum apex and side planes normals (inside: FN & (P - Apex) >= 0)
+    uint32_t Pixel[Size], Sample[Size];  // Sampler pixel (see 'sampler::Pack') and sample numbers
+    bool IsSampled = false;              // Rays have sampler numbers flag
+
+    /* Add ray to packet function.
+     * ARGUMENTS:
+     *   - ray:
+     *       const ray &Ray;
+     * RETURNS:
+     *   (ray_packet &) self reference.
+     */
+    ray_packet & operator<<( const ray &Ray )
+    {
+      if (N < Size)
+        R[N++] = Ray;
+      return *this;
+    } /* End of 'operator<<' function */
+
+    /* Add ray with sampler numbers to packet function.
+     * Shading of ray takes numbers from this sample.
+     * ARGUMENTS:
+     *   - ray:
+     *       const ray &Ray;
+     *   - pixel and sample numbers:
+     *       uint32_t Pix, Smp;
+     * RETURNS:
+     *   (ray_packet &) self reference.
+     */
+    ray_packet & Add( const ray &Ray, uint32_t Pix, uint32_t Smp )
+    {
+      if (N < Size)
+      {
+        Pixel[N] = Pix, Sample[N] = Smp;
+        IsSampled = true;
+        R[N++] = Ray;
+      }
+      return *this;
+    } /* End of 'Add' function */
+
+    /* Prepare packet after adding rays function.
+     * ARGUMENTS:
+     *   - point all rays go through (nullptr for the first ray origin):
+     *       const vec3 *Through;
+     * RETURNS: None.
+     */
+    void Prepare( const vec3 *Through = nullptr )
+    {
+      Mean = vec3(0);
+      for (int i = 0; i < Size; i++)
+      {
+        const ray &r = R[i < N ? i : 0];
+        float big = std::numeric_limits<float>::max();
+
+        OX[i] = (float)r.Org.X, OY[i] = (float)r.Org.Y, OZ[i] = (float)r.Org.Z;
+        DX[i] = (float)r.Dir.X, DY[i] = (float)r.Dir.Y, DZ[i] = (float)r.Dir.Z;
+        IX[i] = r.Dir.X != 0 ? (float)(1 / r.Dir.X) : big;
+        IY[i] = r.Dir.Y != 0 ? (float)(1 / r.Dir.Y) : big;
+        IZ[i] = r.Dir.Z != 0 ? (float)(1 / r.Dir.Z) : big;
+        TMax[i] = i < N ? big : -1;
+        if (i < N)
+          Mean += r.Dir;
+      }
+      IsFrustum = false;
+      if (N == 0 || (Mean & Mean) == 0)
+        return;
+      Mean.Normalize();
+      Apex = Through != nullptr ? *Through : R[0].Org;
+
+      /* Rays must start past apex on their lines */
+      vec3
+        u = (std::abs(Mean.X) < 0.9 ? vec3(1, 0, 0) : vec3(0, 1, 0)) % Mean,
+        v;
+      double a0 = 1e300, a1 = -1e300, b0 = 1e300, b1 = -1e300;
+
+      u.Normalize();
+      v = Mean % u;
+      for (int i = 0; i < N; i++)
+      {
+        vec3 o = R[i].Org - Apex;
+        double l = !o, dm = R[i].Dir & Mean;
+
+        if (dm < 0.1 || (l > 0 && ((!(o % R[i].Dir)) > 1e-9 * l || (o & R[i].Dir) < 0)))
+          return;
+        double a = (R[i].Dir & u) / dm, b = (R[i].Dir & v) / dm;
+
+        a0 = std::min(a0, a), a1 = std::max(a1, a);
+        b0 = std::min(b0, b), b1 = std::max(b1, b);
+      }
+      a0 -= 1e-6, a1 += 1e-6, b0 -= 1e-6, b1 += 1e-6;
+      FN[0] = u - Mean * a0, FN[1] = Mean * a1 - u;
+      FN[2] = v - Mean * b0, FN[3] = Mean * b1 - v;
+      IsFrustum = true;
+    } /* End of 'Prepare' function */
+
+    /* Test hierarchy node box against rays function.
+     * ARGUMENTS:
+     *   - node:
+     *       const bvh::node &Nd;
+     *   - rays to test bit mask:
+     *       int Mask;
+     * RETURNS:
+     *   (int) bit mask of rays which hit box closer than their 'TMax'.
+     */
+    int Hit( const bvh::node &Nd, int Mask ) const
+    {
+      using mth::simd4;
+
+      if (IsFrustum)
+        for (auto &n : FN)
+        {
+          vec3 p(n.X >= 0 ? Nd.B1[0] : Nd.B0[0], n.Y >= 0 ? Nd.B1[1] : Nd.B0[1], n.Z >= 0 ? Nd.B1[2] : Nd.B0[2]);
+
+          if ((n & (p - Apex)) < 0)
+            return 0;
+        }
+
+      simd4
+        x0(Nd.B0[0]), y0(Nd.B0[1]), z0(Nd.B0[2]),
+        x1(Nd.B1[0]), y1(Nd.B1[1]), z1(Nd.B1[2]);
+      int res = 0;
+
+      for (int o = 0; o < Size; o += 4)
+      {
+        if (((Mask >> o) & 15) == 0)
+          continue;
+        simd4
+          ox = simd4::Load(OX + o), oy = simd4::Load(OY + o), oz = simd4::Load(OZ + o),
+          ix = simd4::Load(IX + o), iy = simd4::Load(IY + o), iz = simd4::Load(IZ + o),
+          ax = (x0 - ox) * ix, bx = (x1 - ox) * ix,
+          ay = (y0 - oy) * iy, by = (y1 - oy) * iy,
+          az = (z0 - oz) * iz, bz = (z1 - oz) * iz,
+          tn = Max(Max(Min(ax, bx), Min(ay, by)), Max(Min(az, bz), simd4(0.0f))),
+          tf = Min(Min(Max(ax, bx), Max(ay, by)), Min(Max(az, bz), simd4::Load(TMax + o)));
+
+        res |= (tn <= tf).Mask() << o;
+      }
+      return res & Mask;
+    } /* End of 'Hit' function */
+
+    /* Store closer hit distance of ray function.
+     * ARGUMENTS:
+     *   - ray number:
+     *       int I;
+     *   - hit distance:
+     *       double T;
+     * RETURNS: None.
+     */
+    void Shrink( int I, double T )
+    {
+      /* Rounded up, so boxes at the hit itself are still visited */
+      TMax[I] = (float)(T * (1 + 1e-6));
+    } /* End of 'Shrink' function */
+  }; /* End of 'ray_packet' structure */
+} /* end of 'tp5' namespace */
+
+#endif /* __rt_packet_h_ */
+
+/* END OF 'rt_packet.h' FILE */
@@ -0,0 +1,305 @@
+/* PROJECT     : tp5-rt
+ * FILE NAME   : rt_pool.cpp
+ * PROGRAMMER  : Tim Peterson
+ * LAST UPDATE : 19.10.2026
+ * PURPOSE     : 'thread_pool' methods defenition file.
+ * LICENSE     : MIT License
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif /* __linux__ */
+
+#include "rt_pool.h"
+
+#ifdef __linux__
+/* Get CPU quota of cgroup and its ancestors function.
+ * ARGUMENTS:
+ *   - cgroup path from '/proc/self/cgroup':
+ *       std::string Path;
+ *   - cgroup v2 flag (v1 'cpu' controller otherwise):
+ *       bool IsV2;
+ * RETURNS:
+ *   (double) smallest quota in CPUs, 0 if there is none.
+ */
+static double CgroupQuota( std::string Path, bool IsV2 )
+{
+  double cpus = 0;
+
+  /* Limit may be set on any level, root is the last one checked */
+  while (true)
+  {
+    std::string dir = (IsV2 ? "/sys/fs/cgroup" : "/sys/fs/cgroup/cpu") + (Path == "/" ? "" : Path), quota;
+    double q = 0, period = 0;
+
+    if (IsV2)
+    {
+      std::ifstream f(dir + "/cpu.max");
+
+      if (f >> quota >> period && quota != "max")
+        q = std::stod(quota);
+    }
+    else
+    {
+      std::ifstream fq(dir + "/cpu.cfs_quota_us"), fp(dir + "/cpu.cfs_period_us");
+
+      fq >> q, fp >> period;
+    }
+    if (q > 0 && period > 0)
+      cpus = cpus > 0 ? std::min(cpus, q / period) : q / period;
+    if (Path.empty() || Path == "/")
+      return cpus;
+    size_t k = Path.find_last_of('/');
+
+    Path.erase(k == std::string::npos ? 0 : k);
+  }
+} /* End of 'CgroupQuota' function */
+#endif /* __linux__ */
+
+/* Default pool size function.
+ * ARGUMENTS: None.
+ * RETURNS:
+ *   (int) number of threads, at least 1.
+ */
+int tp5::thread_pool::DefaultSize( void )
+{
+  if (const char *env = std::getenv("TP5_THREADS"); env != nullptr && std::atoi(env) > 0)
+    return std::atoi(env);
+
+  int n = (int)std::thread::hardware_concurrency();
+
+#ifdef __linux__
+  cpu_set_t set;
+
+  if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    n = n > 0 ? std::min(n, CPU_COUNT(&set)) : CPU_COUNT(&set);
+
+  /* Own cgroup from '/proc/self/cgroup': v2 line is '0::/path',
+   * v1 line is 'N:controllers:/path' with 'cpu' among controllers */
+  std::ifstream cg("/proc/self/cgroup");
+  std::string line, v2 = "/", v1 = "/";
+
+  while (std::getline(cg, line))
+  {
+    size_t a = line.find(':'), b = line.find(':', a + 1);
+
+    if (a == std::string::npos || b == std::string::npos)
+      continue;
+    if (line.compare(0, b + 1, "0::") == 0)
+      v2 = line.substr(b + 1);
+    else if (("," + line.substr(a + 1, b - a - 1) + ",").find(",cpu,") != std::string::npos)
+      v1 = line.substr(b + 1);
+  }
+
+  /* cgroup v2 'quota period' or 'max period', then cgroup v1 */
+  double cpus = CgroupQuota(v2, true);
+
+  if (cpus == 0)
+    cpus = CgroupQuota(v1, false);
+  if (cpus > 0)
+    n = std::min(n, std::max(1, (int)std::ceil(cpus)));
+#endif /* __linux__ */
+  return std::max(n, 1);
+} /* End of 'tp5::thread_pool::DefaultSize' function */
+
+/* 'thread_pool' constructor function.
+ * ARGUMENTS:
+ *   - number of workers (0 for 'DefaultSize'):
+ *       int N;
+ *   - pin workers to cores flag (TP5_PIN=1 environment variable also pins):
+ *       bool IsPin;
+ */
+tp5::thread_pool::thread_pool( int N, bool IsPin )
+{
+  const char *env = std::getenv("TP5_PIN");
+
+  IsPinned = IsPin || (env != nullptr && std::atoi(env) != 0);
+  Start(N > 0 ? N : DefaultSize());
+} /* End of 'tp5::thread_pool::thread_pool' function */
+
+/* 'thread_pool' destructor function */
+tp5::thread_pool::~thread_pool( void )
+{
+  Stop();
+} /* End of 'tp5::thread_pool::~thread_pool' function */
+
+/* Start workers function.
+ * ARGUMENTS:
+ *   - number of workers:
+ *       int N;
+ * RETURNS: None.
+ */
+void tp5::thread_pool::Start( int N )
+{
+  IsClosing = false;
+  Threads.resize(N);
+  for (int i = 0; i < N; i++)
+  {
+    Threads[i] = std::thread(
+      [this]( void )
+      {
+        while (true)
+        {
+          std::function<void ( void )> task;
+
+          {
+            std::unique_lock<std::mutex> lk(Lock);
+
+            IsTask.wait(lk, [this]( void ){ return IsClosing || !Tasks.empty(); });
+            if (Tasks.empty())
+              return;
+            task = std::move(Tasks.front());
+            Tasks.pop_front();
+          }
+          task();
+        }
+      });
+#ifdef __linux__
+    if (IsPinned)
+    {
+      cpu_set_t all, one;
+
+      if (sched_getaffinity(0, sizeof(all), &all) == 0 && CPU_COUNT(&all) > 0)
+      {
+        int k = i % CPU_COUNT(&all), c = 0;
+
+        while (!CPU_ISSET(c, &all) || k-- > 0)
+          c++;
+        CPU_ZERO(&one);
+        CPU_SET(c, &one);
+        pthread_setaffinity_np(Threads[i].native_handle(), sizeof(one), &one);
+      }
+    }
+#endif /* __linux__ */
+  }
+} /* End of 'tp5::thread_pool::Start' function */
+
+/* Stop and join workers function.
+ * Queued tasks are finished before workers exit.
+ * ARGUMENTS: None.
+ * RETURNS: None.
+ */
+void tp5::thread_pool::Stop( void )
+{
+  {
+    std::lock_guard<std::mutex> lg(Lock);
+
+    IsClosing = true;
+  }
+  IsTask.notify_all();
+  for (auto &th : Threads)
+    th.join();
+  Threads.clear();
+} /* End of 'tp5::thread_pool::Stop' function */
+
+/* Restart pool with other size function.
+ * ARGUMENTS:
+ *   - number of workers (0 for 'DefaultSize'):
+ *       int N;
+ *   - pin workers to cores flag:
+ *       bool IsPin;
+ * RETURNS: None.
+ */
+void tp5::thread_pool::Resize( int N, bool IsPin )
+{
+  Stop();
+  IsPinned = IsPin;
+  Start(N > 0 ? N : DefaultSize());
+} /* End of 'tp5::thread_pool::Resize' function */
+
+/* Add task to queue function.
+ * ARGUMENTS:
+ *   - task:
+ *       std::function<void ( void )> Task;
+ * RETURNS:
+ *   (std::future<void>) task completion.
+ */
+std::future<void> tp5::thread_pool::Submit( std::function<void ( void )> Task )
+{
+  auto pt = std::make_shared<std::packaged_task<void ( void )>>(std::move(Task));
+  std::future<void> res = pt->get_future();
+
+  {
+    std::lock_guard<std::mutex> lg(Lock);
+
+    Tasks.push_back([pt]( void ){ (*pt)(); });
+  }
+  IsTask.notify_one();
+  return res;
+} /* End of 'tp5::thread_pool::Submit' function */
+
+/* Run one queued task in calling thread function.
+ * ARGUMENTS: None.
+ * RETURNS:
+ *   (bool) true if task was run, false if queue is empty.
+ */
+bool tp5::thread_pool::RunOne( void )
+{
+  std::function<void ( void )> task;
+
+  {
+    std::lock_guard<std::mutex> lg(Lock);
+
+    if (Tasks.empty())
+      return false;
+    task = std::move(Tasks.front());
+    Tasks.pop_front();
+  }
+  task();
+  return true;
+} /* End of 'tp5::thread_pool::RunOne' function */
+
+/* Run function once per worker slot and wait function.
+ * ARGUMENTS:
+ *   - slot function:
+ *       const std::function<void ( int Slot )> &Work;
+ * RETURNS: None.
+ */
+void tp5::thread_pool::Run( const std::function<void ( int Slot )> &Work )
+{
+  stock<std::future<void>> fs;
+
+  for (int i = 1; i < Size(); i++)
+    fs.push_back(Submit([&Work, i]( void ){ Work(i); }));
+  Work(0);
+
+  /* Help with queue while slots are not taken by workers */
+  for (auto &f : fs)
+    while (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+      if (!RunOne())
+        f.wait();
+  for (auto &f : fs)
+    f.get();
+} /* End of 'tp5::thread_pool::Run' function */
+
+/* Run function for every number in range and wait function.
+ * ARGUMENTS:
+ *   - range size:
+ *       int N;
+ *   - body function:
+ *       const std::function<void ( int I )> &Body;
+ * RETURNS: None.
+ */
+void tp5::thread_pool::For( int N, const std::function<void ( int I )> &Body )
+{
+  std::atomic_int next = 0;
+
+  Run(
+    [&]( int )
+    {
+      int i;
+
+      while ((i = next++) < N)
+        Body(i);
+    });
+} /* End of 'tp5::thread_pool::For' function */
+
+/* END OF 'rt_pool.cpp' FILE */
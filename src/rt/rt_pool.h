@@ -0,0 +1,135 @@
+/* PROJECT     : tp5-rt
+ * FILE NAME   : rt_pool.h
+ * PROGRAMMER  : Tim Peterson
+ * LAST UPDATE : 19.10.2026
+ * PURPOSE     : Persistent worker threads pool.
+ * LICENSE     : MIT License
+ */
+
+#ifndef __rt_pool_h_
+#define __rt_pool_h_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "def.h"
+
+/* Base project namespace */
+namespace tp5
+{
+  /* Worker threads pool representation type.
+   * Threads live as long as pool, tasks are taken in submission order.
+   * Waiting functions run queued tasks themselves, so tasks may submit
+   * and wait for other tasks (render task runs tiles tasks) without
+   * deadlock even in pool of one thread.
+   */
+  class thread_pool
+  {
+    stock<std::thread> Threads;                     // Workers
+    std::deque<std::function<void ( void )>> Tasks; // Queued tasks
+    std::mutex Lock;                                // Tasks queue lock
+    std::condition_variable IsTask;                 // Task added or pool closing condition
+    bool IsClosing = false;                         // Workers exit flag
+    bool IsPinned = false;                          // Workers are pinned to cores flag
+
+    /* Start workers function.
+     * ARGUMENTS:
+     *   - number of workers:
+     *       int N;
+     * RETURNS: None.
+     */
+    void Start( int N );
+
+    /* Stop and join workers function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    void Stop( void );
+
+  public:
+    /* Default pool size function.
+     * First of: TP5_THREADS environment variable, else minimum of
+     * cgroup CPU quota, process affinity mask and hardware threads.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (int) number of threads, at least 1.
+     */
+    static int DefaultSize( void );
+
+    /* 'thread_pool' constructor function.
+     * ARGUMENTS:
+     *   - number of workers (0 for 'DefaultSize'):
+     *       int N;
+     *   - pin workers to cores flag (TP5_PIN=1 environment variable also pins):
+     *       bool IsPin;
+     */
+    thread_pool( int N = 0, bool IsPin = false );
+
+    /* 'thread_pool' destructor function */
+    ~thread_pool( void );
+
+    /* Restart pool with other size function.
+     * Must not be called from pool task.
+     * ARGUMENTS:
+     *   - number of workers (0 for 'DefaultSize'):
+     *       int N;
+     *   - pin workers to cores flag:
+     *       bool IsPin;
+     * RETURNS: None.
+     */
+    void Resize( int N, bool IsPin = false );
+
+    /* Get number of workers function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (int) number of workers.
+     */
+    int Size( void ) const
+    {
+      return (int)Threads.size();
+    } /* End of 'Size' function */
+
+    /* Add task to queue function.
+     * ARGUMENTS:
+     *   - task:
+     *       std::function<void ( void )> Task;
+     * RETURNS:
+     *   (std::future<void>) task completion (exception of task is rethrown on get).
+     */
+    std::future<void> Submit( std::function<void ( void )> Task );
+
+    /* Run one queued task in calling thread function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (bool) true if task was run, false if queue is empty.
+     */
+    bool RunOne( void );
+
+    /* Run function once per worker slot and wait function.
+     * Slot 0 runs in calling thread, others go to pool.
+     * ARGUMENTS:
+     *   - slot function:
+     *       const std::function<void ( int Slot )> &Work;
+     * RETURNS: None.
+     */
+    void Run( const std::function<void ( int Slot )> &Work );
+
+    /* Run function for every number in range and wait function.
+     * ARGUMENTS:
+     *   - range size:
+     *       int N;
+     *   - body function:
+     *       const std::function<void ( int I )> &Body;
+     * RETURNS: None.
+     */
+    void For( int N, const std::function<void ( int I )> &Body );
+  }; /* End of 'thread_pool' class */
+} /* end of 'tp5' namespace */
+
+#endif /* __rt_pool_h_ */
+
+/* END OF 'rt_pool.h' FILE */
@@ -0,0 +1,172 @@
+/* PROJECT     : tp5-rt
+ * FILE NAME   : rt_prog.cpp
+ * PROGRAMMER  : Tim Peterson
+ * LAST UPDATE : 19.10.2026
+ * PURPOSE     : 'scene' progressive rendering methods defenition file.
+ * LICENSE     : MIT License
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "rt_scene.h"
+
+/* Render frame tile with one ray per block function.
+ * Ray goes through first pixel center of block, so level with 2 * Step
+ * blocks already has right color in every fourth block.
+ * ARGUMENTS:
+ *   - camera for rendering:
+ *       const camera &Cam;
+ *   - frame to render in:
+ *       frame &Frm;
+ *   - tile corner and size:
+ *       int X0, Y0, W, H;
+ *   - block side (power of 2):
+ *       int Step;
+ *   - frame holds level with 2 * Step blocks flag (its samples are kept):
+ *       bool IsRefine;
+ * RETURNS: None.
+ */
+void tp5::scene::PreviewTile( const camera &Cam, frame &Frm, int X0, int Y0, int W, int H, int Step, bool IsRefine )
+{
+  const int pw = 4, ph = ray_packet::Size / pw, mask = 2 * Step - 1;
+
+  for (int y0 = Y0; y0 < Y0 + H; y0 += Step * ph)
+    for (int x0 = X0; x0 < X0 + W; x0 += Step * pw)
+    {
+      ray_packet pk;
+      vec3 cs[ray_packet::Size];
+      int bx[ray_packet::Size], by[ray_packet::Size];
+
+      for (int y = y0; y < min(y0 + Step * ph, Y0 + H); y += Step)
+        for (int x = x0; x < min(x0 + Step * pw, X0 + W); x += Step)
+          if (!IsRefine || (x & mask) != 0 || (y & mask) != 0)
+          {
+            bx[pk.N] = x, by[pk.N] = y;
+            pk << Cam.FrameRay(x + 0.5, y + 0.5);
+          }
+      if (pk.N == 0)
+        continue;
+      pk.Prepare(&Cam.Loc);
+      TracePacket(pk, cs);
+      for (int i = 0; i < pk.N; i++)
+        Frm.PutHdrRect(bx[i], by[i], min(Step, X0 + W - bx[i]), min(Step, Y0 + H - by[i]), (float)cs[i].X, (float)cs[i].Y, (float)cs[i].Z);
+    }
+} /* End of 'tp5::scene::PreviewTile' function */
+
+/* Add one jittered sample per pixel of tile to sums function.
+ * ARGUMENTS:
+ *   - camera for rendering:
+ *       const camera &Cam;
+ *   - frame to show running average in:
+ *       frame &Frm;
+ *   - tile corner and size:
+ *       int X0, Y0, W, H;
+ *   - pass number:
+ *       int Pass;
+ * RETURNS: None.
+ */
+void tp5::scene::AccumulateTile( const camera &Cam, frame &Frm, int X0, int Y0, int W, int H, int Pass )
+{
+  const int pw = 4, ph = ray_packet::Size / pw;
+  float scale = 1.0f / (Pass + 1);
+  sampler smp;
+  stock<float> px;
+
+  px.resize(W * H * 4);
+  for (int y0 = Y0; y0 < Y0 + H; y0 += ph)
+    for (int x0 = X0; x0 < X0 + W; x0 += pw)
+    {
+      int w = min(pw, X0 + W - x0), h = min(ph, Y0 + H - y0);
+      ray_packet pk;
+      vec3 cs[ray_packet::Size];
+
+      for (int y = 0; y < h; y++)
+        for (int x = 0; x < w; x++)
+        {
+          uint32_t pix = sampler::Pack(x0 + x, y0 + y);
+
+          smp.Start(Sampling, pix, Pass);
+          double u = smp.Get(), v = smp.Get();
+
+          pk.Add(Cam.FrameRay(x0 + x + u, y0 + y + v), pix, Pass);
+        }
+      pk.Prepare(&Cam.Loc);
+      TracePacket(pk, cs);
+      for (int y = 0; y < h; y++)
+        for (int x = 0; x < w; x++)
+        {
+          const vec3 &c = cs[y * w + x];
+          fvec3 &a = Accum[(y0 + y) * Frm.width + x0 + x];
+
+          a += fvec3((float)c.X, (float)c.Y, (float)c.Z);
+          ToHdr(vec3(a.X * scale, a.Y * scale, a.Z * scale), &px[((y0 - Y0 + y) * W + x0 - X0 + x) * 4]);
+        }
+    }
+  Frm.PutHdrTile(X0, Y0, W, H, px.data());
+} /* End of 'tp5::scene::AccumulateTile' function */
+
+/* Render scene progressively until stop function.
+ * ARGUMENTS:
+ *   - camera for rendering:
+ *       const camera &Cam;
+ *   - frame to render in:
+ *       frame &Frm;
+ * RETURNS: None.
+ */
+void tp5::scene::RenderProgressive( const camera &Cam, frame &Frm )
+{
+  bool isfirst = true;
+  int w = 0, h = 0;
+
+  /* Pass is stopped at next tile after any change */
+  auto isrestart =
+    [&]( void )
+    {
+      return Job.IsCanceled() || IsChanged || Frm.width != w || Frm.height != h;
+    };
+
+  while (!Job.IsCanceled())
+  {
+    /* Restart with coarse preview, so image appears at once */
+    if (isfirst || isrestart())
+    {
+      w = Frm.width, h = Frm.height;
+      isfirst = false;
+      IsChanged = false;
+      Prepare(Cam);
+      Accum.assign(w * h, fvec3(0));
+      Passes = 0;
+      ForTiles(w, h, 64, [&]( int X0, int Y0, int W, int H ){ PreviewTile(Cam, Frm, X0, Y0, W, H); }, isrestart);
+    }
+    if (ForTiles(w, h, 16, [&]( int X0, int Y0, int W, int H ){ AccumulateTile(Cam, Frm, X0, Y0, W, H, Passes); }, isrestart))
+      Passes++;
+  }
+} /* End of 'tp5::scene::RenderProgressive' function */
+
+/* Render scene from coarse to fine resolution function.
+ * ARGUMENTS:
+ *   - camera for rendering:
+ *       const camera &Cam;
+ *   - frame to render in:
+ *       frame &Frm;
+ * RETURNS: None.
+ */
+void tp5::scene::RenderPreview( const camera &Cam, frame &Frm )
+{
+  PreviewStep = 0;
+  Prepare(Cam);
+
+  /* Levels skip samples of previous level, so all three trace 1/4 of frame pixels */
+  for (int step = 8; step > 1; step /= 2)
+  {
+    if (!ForTiles(Frm.width, Frm.height, 64, [&]( int X0, int Y0, int W, int H ){ PreviewTile(Cam, Frm, X0, Y0, W, H, step, step < 8); }))
+      return;
+    PreviewStep = step;
+  }
+  Render(Cam, Frm);
+  if (!Job.IsCanceled())
+    PreviewStep = 1;
+} /* End of 'tp5::scene::RenderPreview' function */
+
+/* END OF 'rt_prog.cpp' FILE */
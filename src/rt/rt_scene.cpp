@@ -6,6 +6,8 @@
  * LICENSE     : MIT License
  */
 
+#include <algorithm>
+#include <limits>
 #include <thread>
 
 #include "rt_scene.h"
@@ -25,9 +27,6 @@ tp5::vec3 tp5::scene::Trace( const ray &R, int RecDepth )
   if (RecDepth > MaxRecDepth)
     return vec3(0);
 
-  if (IsToBeStop)
-     return vec3(0);
-
   if (Intersect(R, &in))
   {
     in.P  = R(in.T);
@@ -52,6 +51,24 @@ tp5::vec3 tp5::scene::Trace( const ray &R, int RecDepth )
  */
 tp5::vec3 tp5::scene::Shade( const ray &R, intr *In, int RecDepth )
 {
+  const material &Mtl = In->Shp->GetMaterial(In);
+
+  /* Scattering in medium: light goes equally in all directions */
+  if (In->Shp->IsVolume())
+  {
+    vec3 albedo = In->Shp->Color(In), color = Mtl.Ka * AmbientColor;
+
+    for (auto lg : Lights)
+    {
+      light_info li;
+      double sh = min(max(0.0, lg->Shadow(In->P, &li)), 1.0);
+
+      if (sh > 0)
+        color += albedo * li.Color * sh * Transmittance(ray(In->P, li.Direction), li.Dist);
+    }
+    return color;
+  }
+
   /* Face forward */
   vec3 N = In->N;
 
@@ -69,7 +86,7 @@ tp5::vec3 tp5::scene::Shade( const ray &R, intr *In, int RecDepth )
   vec3 Ref = R.Dir.Reflect(N);
 
   /* Ambient color component */
-  vec3 ambient = In->Shp->Mtl.Ka * AmbientColor;
+  vec3 ambient = Mtl.Ka * AmbientColor;
 
   /* Diffuse color component */
   vec3 diffuse = vec3(0);
@@ -86,6 +103,8 @@ tp5::vec3 tp5::scene::Shade( const ray &R, intr *In, int RecDepth )
     intr in;
 
     sh = min(max(0.0, sh), 1.0);
+    if (sh > 0)
+      sh *= Transmittance(ray(In->P, li.Direction), li.Dist);
 
     vec3 diffuse0 = vec3(0.), specular0 = vec3(0.);
 
@@ -94,17 +113,17 @@ tp5::vec3 tp5::scene::Shade( const ray &R, intr *In, int RecDepth )
       diffuse0 += Kd * li.Color * nl * sh;
  
       if (double rl = Ref & li.Direction; rl > Trashold)
-        specular0 += In->Shp->Mtl.Ks * li.Color * pow(rl, In->Shp->Mtl.Ph) * sh;
+        specular0 += Mtl.Ks * li.Color * pow(rl, Mtl.Ph) * sh;
     }
 
     diffuse += diffuse0;
     specular += specular0;
   }
 
-  vec3 reflect = Trace(ray(In->P + N * Trashold, Ref), ++RecDepth) * In->Shp->Mtl.Kr;
+  vec3 reflect = Trace(ray(In->P + N * Trashold, Ref), ++RecDepth) * Mtl.Kr;
 
   double eta = IsEnter ?
-            In->Shp->Mtl.RefractionCoef / Air : Air / In->Shp->Mtl.RefractionCoef;
+            Mtl.RefractionCoef / Air : Air / Mtl.RefractionCoef;
 
   double sq = 1 - (1 - (R.Dir & N) * (R.Dir & N));
   vec3 refract;
@@ -112,13 +131,13 @@ tp5::vec3 tp5::scene::Shade( const ray &R, intr *In, int RecDepth )
   {
     vec3 T = (R.Dir - N * (R.Dir & N)) * eta - N * sqrt(sq);
 
-    refract = In->Shp->Mtl.Kt * Trace(ray(In->P + T * Trashold, T), RecDepth);
+    refract = Mtl.Kt * Trace(ray(In->P + T * Trashold, T), RecDepth);
   }
   else
   {
     vec3 T = (R.Dir - N * (R.Dir & N)) * eta - N;
 
-    refract = In->Shp->Mtl.Kt * Trace(ray(In->P + T * Trashold, T), RecDepth);
+    refract = Mtl.Kt * Trace(ray(In->P + T * Trashold, T), RecDepth);
   }
   In->Shp->GetNormal(In);
 
@@ -127,82 +146,324 @@ tp5::vec3 tp5::scene::Shade( const ray &R, intr *In, int RecDepth )
   return ambient + diffuse + specular + reflect + refract;
 } /* End of 'tp5::scene::Shade' function */
 
-/* Render whole scene function.
+/* Prepare shapes and hierarchy for rendering function.
+ * ARGUMENTS:
+ *   - camera for rendering:
+ *       const camera &Cam;
+ * RETURNS: None.
+ */
+void tp5::scene::Prepare( const camera &Cam )
+{
+  stock<aabb> all, boxes;
+  stock<char> isbounded;
+
+  /* View setup and bounds may be heavy (meshes levels), so they go to pool */
+  all.resize(Shapes.size());
+  isbounded.resize(Shapes.size());
+  Pool.For((int)Shapes.size(),
+    [&]( int I )
+    {
+      vec3 b0, b1;
+
+      Shapes[I]->SetView(Cam);
+      if (!(isbounded[I] = Shapes[I]->GetBound(b0, b1)))
+        return;
+
+      /* Float box is rounded outwards */
+      float e = (float)(1e-6 * (std::max({std::abs(b0.X), std::abs(b0.Y), std::abs(b0.Z),
+                                          std::abs(b1.X), std::abs(b1.Y), std::abs(b1.Z)}) + 1));
+
+      all[I] << fvec3((float)b0.X - e, (float)b0.Y - e, (float)b0.Z - e) << fvec3((float)b1.X + e, (float)b1.Y + e, (float)b1.Z + e);
+    });
+
+  Bounded.clear();
+  Unbounded.clear();
+  Volumes.clear();
+  for (int i = 0; i < (int)Shapes.size(); i++)
+  {
+    if (Shapes[i]->IsVolume())
+      Volumes << Shapes[i];
+    if (isbounded[i])
+      Bounded << Shapes[i], boxes << all[i];
+    else
+      Unbounded << Shapes[i];
+  }
+  Bvh.Build((int)Bounded.size(), [&]( int I ){ return boxes[I]; }, 2);
+  Bvh.Reorder(Bounded);
+} /* End of 'tp5::scene::Prepare' function */
+
+/* Trace packet of primary rays function.
+ * ARGUMENTS:
+ *   - rays packet:
+ *       ray_packet &P;
+ *   - colors of rays to fill:
+ *       vec3 *Colors;
+ *   - primary intersections to fill (shape is nullptr for miss), may be nullptr:
+ *       intr *Hits;
+ * RETURNS: None.
+ */
+void tp5::scene::TracePacket( ray_packet &P, vec3 *Colors, intr *Hits )
+{
+  intr in[ray_packet::Size];
+  sampler &smp = sampler::Thread();
+
+  IntersectPacket(P, in);
+  if (Hits != nullptr)
+    std::copy(in, in + P.N, Hits);
+  for (int i = 0; i < P.N; i++)
+    if (in[i].Shp != nullptr)
+    {
+      /* First two sample dimensions are position in pixel */
+      if (P.IsSampled)
+        smp.Start(Sampling, P.Pixel[i], P.Sample[i], 2);
+      in[i].P = P.R[i](in[i].T);
+      in[i].Shp->GetNormal(&in[i]);
+      Colors[i] = Shade(P.R[i], &in[i], 0);
+    }
+    else
+      Colors[i] = BackgroundColor;
+  smp.Stop();
+} /* End of 'tp5::scene::TracePacket' function */
+
+/* Store color to linear frame tile pixel function.
+ * Colors are kept unclamped, frame tonemaps them for display.
+ * ARGUMENTS:
+ *   - color:
+ *       const vec3 &C;
+ *   - pixel RGBA floats to fill:
+ *       float *P;
+ * RETURNS: None.
+ */
+void tp5::scene::ToHdr( const vec3 &C, float *P )
+{
+  P[0] = (float)C.X;
+  P[1] = (float)C.Y;
+  P[2] = (float)C.Z;
+  P[3] = 1;
+} /* End of 'tp5::scene::ToHdr' function */
+
+/* Render frame tile first pass function.
  * ARGUMENTS:
  *   - camera for rendering:
  *       const camera &Cam;
  *   - frame to render in:
  *       frame &Frm;
+ *   - tile corner and size:
+ *       int X0, Y0, W, H;
+ * RETURNS: None.
+ */
+void tp5::scene::RenderTile( const camera &Cam, frame &Frm, int X0, int Y0, int W, int H )
+{
+  /* Primary rays go in 4 x 4 pixel packets, tile is put to frame at once */
+  const int pw = 4, ph = ray_packet::Size / pw;
+  bool isadaptive = Antialias == antialias::ADAPTIVE;
+  stock<float> px;
+
+  px.resize(W * H * 4);
+  if (Antialias == antialias::UNIFORM)
+  {
+    stock<std::pair<int, int>> pixels;
+    stock<vec3> colors;
+
+    pixels.reserve(W * H);
+    for (int y = 0; y < H; y++)
+      for (int x = 0; x < W; x++)
+        pixels.emplace_back(X0 + x, Y0 + y);
+    SuperSample(Cam, pixels, colors);
+    for (int i = 0; i < W * H; i++)
+      ToHdr(colors[i], &px[i * 4]);
+    Frm.PutHdrTile(X0, Y0, W, H, px.data());
+    return;
+  }
+  if (Integrator == integrator::WAVEFRONT)
+  {
+    stock<vec3> colors;
+    stock<intr> hits;
+
+    hits.resize(isadaptive ? W * H : 0);
+    TraceWave(Cam, X0, Y0, W, H, colors, isadaptive ? hits.data() : nullptr);
+    for (int y = 0; y < H; y++)
+      for (int x = 0; x < W; x++)
+      {
+        int i = y * W + x;
+
+        if (isadaptive)
+          Primary[(Y0 + y) * Frm.width + X0 + x] = {colors[i], (float)hits[i].T, hits[i].Shp};
+        ToHdr(colors[i], &px[i * 4]);
+      }
+    Frm.PutHdrTile(X0, Y0, W, H, px.data());
+    return;
+  }
+  for (int y0 = Y0; y0 < Y0 + H; y0 += ph)
+    for (int x0 = X0; x0 < X0 + W; x0 += pw)
+    {
+      int w = std::min(pw, X0 + W - x0), h = std::min(ph, Y0 + H - y0);
+      vec3 cs[ray_packet::Size];
+      intr in[ray_packet::Size];
+      ray_packet pk;
+
+      for (int y = 0; y < h; y++)
+        for (int x = 0; x < w; x++)
+          pk.Add(Cam.FrameRay(x0 + x + 0.5, y0 + y + 0.5), sampler::Pack(x0 + x, y0 + y), 0);
+      pk.Prepare(&Cam.Loc);
+      TracePacket(pk, cs, isadaptive ? in : nullptr);
+      for (int y = 0; y < h; y++)
+        for (int x = 0; x < w; x++)
+        {
+          const vec3 &c = cs[y * w + x];
+
+          if (isadaptive)
+            Primary[(y0 + y) * Frm.width + x0 + x] = {c, (float)in[y * w + x].T, in[y * w + x].Shp};
+          ToHdr(c, &px[((y0 - Y0 + y) * W + x0 - X0 + x) * 4]);
+        }
+    }
+  Frm.PutHdrTile(X0, Y0, W, H, px.data());
+} /* End of 'tp5::scene::RenderTile' function */
+
+/* Run tile function over whole frame in render threads function.
+ * ARGUMENTS:
+ *   - frame size:
+ *       int W, H;
+ *   - tile side:
+ *       int Size;
+ *   - tile function (corner and size):
+ *       const std::function<void ( int X0, int Y0, int W, int H )> &Tile;
+ *   - stop check before every tile (empty for job cancellation):
+ *       const std::function<bool ( void )> &IsStop;
+ *   - point to render first tiles around, may be nullptr:
+ *       const vec2 *Focus;
+ * RETURNS:
+ *   (bool) true if all tiles are done, false if stopped.
+ */
+bool tp5::scene::ForTiles( int W, int H, int Size, const std::function<void ( int X0, int Y0, int W, int H )> &Tile,
+                           const std::function<bool ( void )> &IsStop, const vec2 *Focus )
+{
+  Scheduler.Cut(W, H, Size, Focus);
+  return Scheduler.Run(Pool, [&]( const tile_scheduler::tile &T ){ Tile(T.X0, T.Y0, T.W, T.H); },
+    IsStop ? IsStop : [this]( void ){ return Job.IsCanceled(); });
+} /* End of 'tp5::scene::ForTiles' function */
+
+/* Log last tiles run statistics if 'IsLogTiles' is set function.
+ * ARGUMENTS:
+ *   - run name:
+ *       const char *Name;
  * RETURNS: None.
  */
-void tp5::scene::Render( const camera &Cam, frame &Frm )
+void tp5::scene::LogTiles( const char *Name ) const
+{
+  const tile_scheduler::stats &st = Scheduler.GetStats();
+
+  if (!IsLogTiles)
+    return;
+  std::cout << Name << ": " << st.Wall << " ms, tail " << st.Tail << " ms\n";
+  for (int i = 0; i < (int)st.Busy.size(); i++)
+    std::cout << "  thread " << i << ": " << st.Tiles[i] << " tiles (" << st.Steals[i] << " stolen), " <<
+      (st.Wall > 0 ? 100 * st.Busy[i] / st.Wall : 0) << "% busy\n";
+} /* End of 'tp5::scene::LogTiles' function */
+
+/* Render whole scene function.
+ * ARGUMENTS:
+ *   - camera for rendering:
+ *       const camera &Cam;
+ *   - frame to render in:
+ *       frame &Frm;
+ *   - point in frame to render first, may be nullptr:
+ *       const vec2 *Focus;
+ */
+void tp5::scene::Render( const camera &Cam, frame &Frm, const vec2 *Focus )
 {
-  int n = std::thread::hardware_concurrency() - 1;
-  std::cout << "Log Scene.Render\nN: " << n << "\n";
-// #ifndef NDEBUG
-//   n = 1;
-// #endif /* NDEBUG */
-  std::vector<std::thread> Ths;
-  Ths.resize(n);
-  StartRow = 0;
-  for (int i = 0; i < n; i++)
+  /* Wavefront mode takes bigger tiles, so waves are long enough to sort */
+  const int ts = Integrator == integrator::WAVEFRONT ? 32 : 16, tw = (Frm.width + ts - 1) / ts;
+  stock<byte> isfinal;
+  std::cout << "Log Scene.Render\nN: " << Pool.Size() << "\n";
+
+  Prepare(Cam);
+  if (Antialias == antialias::ADAPTIVE)
+    Primary.resize(Frm.width * Frm.height);
+
+  /* Fovea pass: sample step doubles at 1, 2 and 4 radii from focus */
+  if (Focus != nullptr)
   {
-    Ths[i] = std::thread(
-      [&]( void )
+    isfinal.assign(tw * ((Frm.height + ts - 1) / ts), 0);
+    bool iscovered = ForTiles(Frm.width, Frm.height, ts,
+      [&]( int X0, int Y0, int W, int H )
       {
-        int y = 0;
-        while (y < Frm.height)
+        double
+          dx = X0 + W * 0.5 - Focus->X, dy = Y0 + H * 0.5 - Focus->Y,
+          d = sqrt(dx * dx + dy * dy) / FoveaRadius;
+
+        if (d < 1)
         {
-          y = StartRow++;
-          for (int x = 0; x < Frm.width; x++)
-          {
-#if 1
-            ray r = Cam.FrameRay(x + 0.5, y + 0.5);
-            vec3 c = Trace(r, 0);
-#else
-            int sub = 4;
-            double ss = 1.0 / sub;
-            vec3 c = vec3(0);
-            for (int i = 0; i < sub; i++)
-              for (int j = 0; j < sub; j++)
-              {
-                ray r = Cam.FrameRay(x + 0.5 + ss * i, y + 0.5 + ss * j);
-                c += Trace(r, 0);
-              }
-            c /= sub * sub;
-            // c *= 255;
-            /*
-            ray r1 = Cam.FrameRay(x + 0.5 - 0.2, y + 0.5 - 0.2);
-            ray r2 = Cam.FrameRay(x + 0.5 - 0.2, y + 0.5 + 0.2);
-            ray r3 = Cam.FrameRay(x + 0.5 + 0.2, y + 0.5 - 0.2);
-            ray r4 = Cam.FrameRay(x + 0.5 + 0.2, y + 0.5 + 0.2);
-            vec3 c1 = Trace(r1, 0);
-            vec3 c2 = Trace(r2, 0);
-            vec3 c3 = Trace(r3, 0);
-            vec3 c4 = Trace(r4, 0);
-            vec3 c = (c1 + c2 + c3 + c4) / 4;
-            */
-#endif
-            // Frm.PutPixel(x, y, frame::RGBA(c.X, c.Y, c.Z, 255));  
-            auto clamp = 
-              []( double Value ) -> byte
-              {
-                if (Value < 0)
-                  return 0;
-                if (Value > 1)
-                  return 255;
-                return Value * 255;
-              };
-            Frm.PutPixel(x, y, frame::RGBA(clamp(c.X), clamp(c.Y), clamp(c.Z)));
-          }
+          RenderTile(Cam, Frm, X0, Y0, W, H);
+          isfinal[Y0 / ts * tw + X0 / ts] = 1;
         }
-      });
+        else
+          FoveaTile(Cam, Frm, X0, Y0, W, H, d < 2 ? 2 : d < 4 ? 4 : 8);
+      }, nullptr, Focus);
+    LogTiles("Fovea");
+    if (!iscovered)
+      return;
+  }
+  bool isdone = ForTiles(Frm.width, Frm.height, ts,
+    [&]( int X0, int Y0, int W, int H )
+    {
+      if (isfinal.empty() || !isfinal[Y0 / ts * tw + X0 / ts])
+        RenderTile(Cam, Frm, X0, Y0, W, H);
+    }, nullptr, Focus);
+  LogTiles("Render");
+
+  /* Second pass needs all neighbours of first one */
+  if (Antialias == antialias::ADAPTIVE && isdone)
+  {
+    Refined = 0;
+    ForTiles(Frm.width, Frm.height, 16, [&]( int X0, int Y0, int W, int H ){ RefineTile(Cam, Frm, X0, Y0, W, H); }, nullptr, Focus);
+    LogTiles("Refine");
+    if (IsLogTiles)
+      std::cout << "Refined: " << Refined << " of " << Frm.width * Frm.height << " pixels\n";
   }
-  for (int i = 0; i < n; i++)
-    Ths[i].join();
-  IsToBeStop = false;
 } /* End of 'tp5::scene::Render' function */
 
+/* Start rendering in pool function.
+ * ARGUMENTS:
+ *   - camera for rendering (must not change until job stops):
+ *       const camera &Cam;
+ *   - frame to render in:
+ *       frame &Frm;
+ *   - rendering mode:
+ *       render_mode Mode;
+ *   - function to call in render thread after rendering, may be empty:
+ *       std::function<void ( void )> OnDone;
+ *   - final mode focus point (copied), may be nullptr:
+ *       const vec2 *Focus;
+ * RETURNS:
+ *   (bool) true if started, false if other render is running.
+ */
+bool tp5::scene::RenderAsync( const camera &Cam, frame &Frm, render_mode Mode, std::function<void ( void )> OnDone,
+                              const vec2 *Focus )
+{
+  bool isfocus = Focus != nullptr;
+  vec2 focus = isfocus ? *Focus : vec2(0);
+
+  if (!Job.Start())
+    return false;
+  this->Mode = Mode;
+  PreviewStep = 0;
+  Pool.Submit(
+    [this, &Cam, &Frm, Mode, OnDone, isfocus, focus]( void )
+    {
+      if (Mode == render_mode::PROGRESSIVE)
+        RenderProgressive(Cam, Frm);
+      else if (Mode == render_mode::PREVIEW)
+        RenderPreview(Cam, Frm);
+      else
+        Render(Cam, Frm, isfocus ? &focus : nullptr);
+      if (OnDone)
+        OnDone();
+      Job.Finish();
+    });
+  return true;
+} /* End of 'tp5::scene::RenderAsync' function */
+
 /* Intersect all objects function.
  * ARGUMENTS:
  *   - ray to intersect with:
@@ -215,21 +476,108 @@ void tp5::scene::Render( const camera &Cam, frame &Frm )
 bool tp5::scene::Intersect( const ray &R, intr *In )
 {
   intr best_intr;
-  best_intr.T = -1;
- 
-  for (auto shp : Shapes)
-  {
-    intr current_intr;
-    if (shp->Intersect(R, &current_intr) &&
-        (best_intr.T == -1 || (current_intr.T < best_intr.T && current_intr.T > 0)))
+  double tmax = std::numeric_limits<double>::max();
+  auto test =
+    [&]( shape *Shp, double &TMax )
+    {
+      intr current_intr;
+
+      if (!Shp->Intersect(R, &current_intr) || current_intr.T <= 0 || current_intr.T >= TMax)
+        return false;
       best_intr = current_intr;
-  }
+      TMax = current_intr.T;
+      return true;
+    };
+
+  /* Same shapes as 'IntersectPacket' takes: unbounded ones and hierarchy */
+  best_intr.T = -1;
+  for (auto shp : Unbounded)
+    test(shp, tmax);
+  Bvh.Traverse(R, tmax,
+    [&]( int First, int Count, double &TMax )
+    {
+      bool hit = false;
+
+      for (int i = First; i < First + Count; i++)
+        hit |= test(Bounded[i], TMax);
+      return hit;
+    });
   if (best_intr.T == -1)
     return false;
   *In = best_intr;
   return true;
 } /* End of 'tp5::scene::Intersect' function */
 
+/* Intersect all objects with rays packet function.
+ * ARGUMENTS:
+ *   - rays packet (prepared):
+ *       ray_packet &P;
+ *   - intersections to fill ('Shp' is nullptr for missed rays):
+ *       intr *In;
+ * RETURNS: None.
+ */
+void tp5::scene::IntersectPacket( ray_packet &P, intr *In )
+{
+  struct item
+  {
+    int Node, Mask;
+  } stack[128];
+  int sp = 0, all = (1 << P.N) - 1;
+
+  for (int i = 0; i < P.N; i++)
+    In[i] = intr();
+
+  /* Planes and such come first: their hits shorten rays for boxes tests */
+  for (auto shp : Unbounded)
+    shp->IntersectPacket(P, all, In);
+  if (!Bvh.Nodes.empty())
+    stack[sp++] = {0, all};
+  while (sp > 0)
+  {
+    item it = stack[--sp];
+    const bvh::node &nd = Bvh.Nodes[it.Node];
+    int m = P.Hit(nd, it.Mask);
+
+    if (m == 0)
+      continue;
+    if (nd.Count > 0)
+    {
+      for (int i = nd.First; i < nd.First + nd.Count; i++)
+        Bounded[i]->IntersectPacket(P, m, In);
+      continue;
+    }
+
+    /* Closer child along packet direction goes to the top of stack */
+    auto depth = [&]( const bvh::node &C )
+    {
+      return (C.B0[0] + C.B1[0]) * P.Mean.X + (C.B0[1] + C.B1[1]) * P.Mean.Y + (C.B0[2] + C.B1[2]) * P.Mean.Z;
+    };
+    bool left = depth(Bvh.Nodes[nd.First]) < depth(Bvh.Nodes[nd.First + 1]);
+
+    stack[sp++] = {nd.First + left, m};
+    stack[sp++] = {nd.First + !left, m};
+  }
+} /* End of 'tp5::scene::IntersectPacket' function */
+
+/* Get part of light passing through scene media function.
+ * ARGUMENTS:
+ *   - segment start and direction:
+ *       const ray &R;
+ *   - segment length:
+ *       double Dist;
+ * RETURNS:
+ *   (double) transmittance.
+ */
+double tp5::scene::Transmittance( const ray &R, double Dist )
+{
+  double tr = 1;
+
+  for (auto shp : Shapes)
+    if ((tr *= shp->Transmittance(R, Dist)) == 0)
+      break;
+  return tr;
+} /* End of 'tp5::scene::Transmittance' function */
+
 /* Add shape to scene operator function.
  * ARGUMENTS:
  *   - pointer to shape to add:
@@ -238,6 +586,7 @@ bool tp5::scene::Intersect( const ray &R, intr *In )
 tp5::scene & tp5::scene::operator<<( shape *Shape )
 {
   Shapes << Shape;
+  IsChanged = true;
   return *this;
 } /* End of 'tp5::scene::operator<<' function */
 
@@ -249,6 +598,7 @@ tp5::scene & tp5::scene::operator<<( shape *Shape )
 tp5::scene & tp5::scene::operator<<( light *Light )
 {
   Lights << Light;
+  IsChanged = true;
   return *this;
 } /* End of 'tp5::scene::operat  or<<' function */
 
@@ -14,6 +14,8 @@
 #include "rt/shapes/shapes.h"
 #include "rt/lights/lights.h"
 #include "rt/mods/mods.h"
+#include "rt/rt_job.h"
+#include "rt/rt_sched.h"
 #include "frame/frame.h"
 
 /* Base project namespace */
@@ -23,19 +25,88 @@ namespace tp5
   class scene
   {
   public:
-    std::atomic_bool IsRenderActive  = false; // Sync flags
-    std::atomic_bool IsToBeStop      = false; // Waiting for stop flag
-    std::atomic_bool IsReadyToFinish = true;  // Waiting to finish program flag
-    std::atomic_int  StartRow        = 0;     // Store rendering line
+    /* Rendering integrator kind */
+    enum class integrator
+    {
+      RECURSIVE, // Depth first 'Trace' - 'Shade' recursion per pixel
+      WAVEFRONT  // Ray waves with hits shaded in shape type and material order
+    }; /* End of 'integrator' enumeration */
+
+    /* Anti-aliasing mode */
+    enum class antialias
+    {
+      NONE,     // One sample at pixel center
+      UNIFORM,  // 4 x 4 samples in every pixel
+      ADAPTIVE  // One sample, then 4 x 4 samples only at color, depth or shape edges
+    }; /* End of 'antialias' enumeration */
+
+    /* Asynchronous rendering mode */
+    enum class render_mode
+    {
+      FINAL,       // One frame with current integrator and anti-aliasing
+      PROGRESSIVE, // Jittered passes accumulated until stop
+      PREVIEW      // 1/8, 1/4 and 1/2 resolution frames, then final one
+    }; /* End of 'render_mode' enumeration */
+
+    render_job       Job;                     // Current render handle (cancel, wait)
+    render_mode      Mode = render_mode::FINAL; // Mode of last started render
+    std::atomic_bool IsChanged       = false; // Shapes or lights changed since last progressive pass
+    std::atomic_int  Passes          = 0;     // Progressive passes accumulated
+    std::atomic_int  PreviewStep     = 0;     // Block side of last finished preview level (0 if none)
   private:
     stock<shape *> Shapes;      // Container with shapes
     stock<light *> Lights;      // Container with lights
     int            MaxRecDepth; // Max recoursion depth
+    bvh            Bvh;         // Hierarchy over bounded shapes for packets
+    stock<shape *>
+      Bounded,                  // Bounded shapes in hierarchy order
+      Unbounded,                // Shapes without bound box
+      Volumes;                  // Participating media shapes
+
+    /* Wavefront ray to trace */
+    struct wave_ray
+    {
+      ray R;     // Ray
+      vec3 W;    // Weight of ray color in pixel
+      int Pixel; // Pixel number in band
+      int Depth; // Recursion depth
+    }; /* End of 'wave_ray' structure */
+
+    /* Wavefront light visibility query */
+    struct wave_shadow
+    {
+      ray R;     // From point to light
+      double D;  // Distance to light
+      vec3 C;    // Unoccluded weighted light contribution
+      int Pixel; // Pixel number in band
+    }; /* End of 'wave_shadow' structure */
+
+    /* First pass pixel sample for adaptive anti-aliasing */
+    struct pixel_sample
+    {
+      vec3 C;     // Color
+      float T;    // Primary hit distance
+      shape *Shp; // Primary hit shape (nullptr for background)
+    }; /* End of 'pixel_sample' structure */
+
+    stock<pixel_sample> Primary; // Frame first pass samples
+    stock<fvec3> Accum;          // Progressive mode color sums
+    tile_scheduler Scheduler;    // Render threads tiles scheduler
+    std::atomic_int Refined;     // Number of supersampled pixels in last render
   public:
     vec3
       BackgroundColor,  // Color of back ground
       AmbientColor;     // Scene abmient color
     double Air;         // Air density
+    integrator Integrator = integrator::RECURSIVE; // Rendering mode
+    antialias Antialias = antialias::NONE;         // Anti-aliasing mode
+    sampler::kind Sampling = sampler::kind::SOBOL; // Pixel, lights and materials sample sequence
+    double
+      EdgeColor = 0.0625, // Adaptive mode neighbour color difference to refine
+      EdgeDepth = 0.05,   // Adaptive mode neighbour relative depth difference to refine
+      FoveaRadius = 128;  // Foveated mode full density radius in pixels (density halves at 2 and 4 radii)
+    bool IsLogTiles = false; // Print tiles statistics after every 'Render' pass
+    thread_pool Pool;     // Render, loading and building worker threads (last, so joined first)
 
     /* Trace ray function.
      * ARGUMENTS:
@@ -57,6 +128,207 @@ namespace tp5
      */
     vec3 Shade( const ray &R, intr *In, int RecDepth );
 
+    /* Prepare shapes and hierarchy for rendering function.
+     * ARGUMENTS:
+     *   - camera for rendering:
+     *       const camera &Cam;
+     * RETURNS: None.
+     */
+    void Prepare( const camera &Cam );
+
+    /* Trace packet of primary rays function.
+     * ARGUMENTS:
+     *   - rays packet:
+     *       ray_packet &P;
+     *   - colors of rays to fill:
+     *       vec3 *Colors;
+     *   - primary intersections to fill (shape is nullptr for miss), may be nullptr:
+     *       intr *Hits;
+     * RETURNS: None.
+     */
+    void TracePacket( ray_packet &P, vec3 *Colors, intr *Hits = nullptr );
+
+    /* Trace frame tile by ray waves function.
+     * ARGUMENTS:
+     *   - camera for rendering:
+     *       const camera &Cam;
+     *   - tile corner and size:
+     *       int X0, Y0, W, H;
+     *   - tile colors to fill (row by row):
+     *       stock<vec3> &Colors;
+     *   - tile primary intersections to fill, may be nullptr:
+     *       intr *Hits;
+     * RETURNS: None.
+     */
+    void TraceWave( const camera &Cam, int X0, int Y0, int W, int H, stock<vec3> &Colors, intr *Hits = nullptr );
+
+    /* Trace primary rays by waves function.
+     * ARGUMENTS:
+     *   - camera for rendering:
+     *       const camera &Cam;
+     *   - primary wave (all rays start at camera, cleared after tracing):
+     *       stock<wave_ray> &Wave;
+     *   - number of pixels:
+     *       int N;
+     *   - pixels colors to fill:
+     *       stock<vec3> &Colors;
+     *   - pixels primary intersections to fill, may be nullptr:
+     *       intr *Hits;
+     * RETURNS: None.
+     */
+    void TraceWave( const camera &Cam, stock<wave_ray> &Wave, int N, stock<vec3> &Colors, intr *Hits = nullptr );
+
+    /* Get pixel stratified sample ray function.
+     * ARGUMENTS:
+     *   - camera for rendering:
+     *       const camera &Cam;
+     *   - pixel coordinates:
+     *       int X, Y;
+     *   - sample number (0 - 15):
+     *       int I;
+     * RETURNS:
+     *   (ray) sample ray.
+     */
+    ray SampleRay( const camera &Cam, int X, int Y, int I ) const;
+
+    /* Trace pixel with 4 x 4 stratified samples function.
+     * ARGUMENTS:
+     *   - camera for rendering:
+     *       const camera &Cam;
+     *   - pixel coordinates:
+     *       int X, Y;
+     * RETURNS:
+     *   (vec3) mean color.
+     */
+    vec3 SuperSample( const camera &Cam, int X, int Y );
+
+    /* Trace pixels with 4 x 4 stratified samples by current integrator function.
+     * ARGUMENTS:
+     *   - camera for rendering:
+     *       const camera &Cam;
+     *   - pixels coordinates:
+     *       const stock<std::pair<int, int>> &Pixels;
+     *   - mean colors to fill:
+     *       stock<vec3> &Colors;
+     * RETURNS: None.
+     */
+    void SuperSample( const camera &Cam, const stock<std::pair<int, int>> &Pixels, stock<vec3> &Colors );
+
+    /* Store color to linear frame tile pixel function.
+     * ARGUMENTS:
+     *   - color:
+     *       const vec3 &C;
+     *   - pixel RGBA floats to fill:
+     *       float *P;
+     * RETURNS: None.
+     */
+    static void ToHdr( const vec3 &C, float *P );
+
+    /* Render frame tile first pass function.
+     * ARGUMENTS:
+     *   - camera for rendering:
+     *       const camera &Cam;
+     *   - frame to render in:
+     *       frame &Frm;
+     *   - tile corner and size:
+     *       int X0, Y0, W, H;
+     * RETURNS: None.
+     */
+    void RenderTile( const camera &Cam, frame &Frm, int X0, int Y0, int W, int H );
+
+    /* Check if first pass pixel differs from its neighbours function.
+     * ARGUMENTS:
+     *   - pixel coordinates:
+     *       int X, Y;
+     *   - frame size:
+     *       int W, H;
+     * RETURNS:
+     *   (bool) true if pixel lies on edge.
+     */
+    bool IsEdge( int X, int Y, int W, int H ) const;
+
+    /* Supersample edge pixels of tile function.
+     * ARGUMENTS:
+     *   - camera for rendering:
+     *       const camera &Cam;
+     *   - frame to render in:
+     *       frame &Frm;
+     *   - tile corner and size:
+     *       int X0, Y0, W, H;
+     * RETURNS: None.
+     */
+    void RefineTile( const camera &Cam, frame &Frm, int X0, int Y0, int W, int H );
+
+    /* Run tile function over whole frame in render threads function.
+     * ARGUMENTS:
+     *   - frame size:
+     *       int W, H;
+     *   - tile side:
+     *       int Size;
+     *   - tile function (corner and size):
+     *       const std::function<void ( int X0, int Y0, int W, int H )> &Tile;
+     *   - stop check before every tile (empty for job cancellation):
+     *       const std::function<bool ( void )> &IsStop;
+     *   - point to render first tiles around, may be nullptr:
+     *       const vec2 *Focus;
+     * RETURNS:
+     *   (bool) true if all tiles are done, false if stopped.
+     */
+    bool ForTiles( int W, int H, int Size, const std::function<void ( int X0, int Y0, int W, int H )> &Tile,
+                   const std::function<bool ( void )> &IsStop = nullptr, const vec2 *Focus = nullptr );
+
+    /* Log last tiles run statistics if 'IsLogTiles' is set function.
+     * ARGUMENTS:
+     *   - run name:
+     *       const char *Name;
+     * RETURNS: None.
+     */
+    void LogTiles( const char *Name ) const;
+
+    /* Render frame tile with one ray per block function.
+     * ARGUMENTS:
+     *   - camera for rendering:
+     *       const camera &Cam;
+     *   - frame to render in:
+     *       frame &Frm;
+     *   - tile corner and size:
+     *       int X0, Y0, W, H;
+     *   - block side (power of 2):
+     *       int Step;
+     *   - frame holds level with 2 * Step blocks flag (its samples are kept):
+     *       bool IsRefine;
+     * RETURNS: None.
+     */
+    void PreviewTile( const camera &Cam, frame &Frm, int X0, int Y0, int W, int H, int Step = 4, bool IsRefine = false );
+
+    /* Add one jittered sample per pixel of tile to sums function.
+     * ARGUMENTS:
+     *   - camera for rendering:
+     *       const camera &Cam;
+     *   - frame to show running average in:
+     *       frame &Frm;
+     *   - tile corner and size:
+     *       int X0, Y0, W, H;
+     *   - pass number:
+     *       int Pass;
+     * RETURNS: None.
+     */
+    void AccumulateTile( const camera &Cam, frame &Frm, int X0, int Y0, int W, int H, int Pass );
+
+    /* Render frame tile by sparse samples and bilinear upsampling function.
+     * ARGUMENTS:
+     *   - camera for rendering:
+     *       const camera &Cam;
+     *   - frame to render in:
+     *       frame &Frm;
+     *   - tile corner and size:
+     *       int X0, Y0, W, H;
+     *   - distance between samples in pixels:
+     *       int Step;
+     * RETURNS: None.
+     */
+    void FoveaTile( const camera &Cam, frame &Frm, int X0, int Y0, int W, int H, int Step );
+
   public:
     /* 'scene' class default constructor function */
     scene( void ) : BackgroundColor(0.0, 0.1, 0.0), AmbientColor(1, 1, 1), MaxRecDepth(2), Air(0.95)
@@ -64,15 +336,67 @@ namespace tp5
     } /* End of '' function */
 
     /* Render whole scene function.
+     * With focus point frame is first covered with sample density falling
+     * off from it (tiles within 'FoveaRadius' are final at once, far ones
+     * are upsampled), then rest of tiles are rendered nearest first.
+     * Final image does not depend on focus.
      * ARGUMENTS:
      *   - camera for rendering:
      *       const camera &Cam;
      *   - frame to render in:
      *       frame &Frm;
+     *   - point in frame to render first, may be nullptr:
+     *       const vec2 *Focus;
      */
-    void Render( const camera &Cam, frame &Frm );
+    void Render( const camera &Cam, frame &Frm, const vec2 *Focus = nullptr );
+
+    /* Render scene progressively until stop function.
+     * Every pass adds one jittered sample per pixel and shows running
+     * average. Accumulation restarts when frame size, shapes or lights
+     * change, camera change needs job stop and new start.
+     * ARGUMENTS:
+     *   - camera for rendering:
+     *       const camera &Cam;
+     *   - frame to render in:
+     *       frame &Frm;
+     * RETURNS: None.
+     */
+    void RenderProgressive( const camera &Cam, frame &Frm );
+
+    /* Render scene from coarse to fine resolution function.
+     * Frame is covered by 8 x 8, 4 x 4 and 2 x 2 pixel blocks, then
+     * rendered as by 'Render'. Every level is drawn over previous one, so
+     * cancelled job leaves best level reached in frame.
+     * ARGUMENTS:
+     *   - camera for rendering:
+     *       const camera &Cam;
+     *   - frame to render in:
+     *       frame &Frm;
+     * RETURNS: None.
+     */
+    void RenderPreview( const camera &Cam, frame &Frm );
+
+    /* Start rendering in pool function.
+     * 'Job' is the handle to cancel or wait for rendering.
+     * ARGUMENTS:
+     *   - camera for rendering (must not change until job stops):
+     *       const camera &Cam;
+     *   - frame to render in:
+     *       frame &Frm;
+     *   - rendering mode:
+     *       render_mode Mode;
+     *   - function to call in render thread after rendering, may be empty:
+     *       std::function<void ( void )> OnDone;
+     *   - final mode focus point (copied), may be nullptr:
+     *       const vec2 *Focus;
+     * RETURNS:
+     *   (bool) true if started, false if other render is running.
+     */
+    bool RenderAsync( const camera &Cam, frame &Frm, render_mode Mode, std::function<void ( void )> OnDone = nullptr,
+                      const vec2 *Focus = nullptr );
 
     /* Intersect all objects function.
+     * Shapes hierarchy is built by 'Prepare'.
      * ARGUMENTS:
      *   - ray to intersect with:
      *       const ray &R;
@@ -83,6 +407,37 @@ namespace tp5
      */
     bool Intersect( const ray &R, intr *In );
 
+    /* Intersect all objects with rays packet function.
+     * ARGUMENTS:
+     *   - rays packet (prepared):
+     *       ray_packet &P;
+     *   - intersections to fill ('Shp' is nullptr for missed rays):
+     *       intr *In;
+     * RETURNS: None.
+     */
+    void IntersectPacket( ray_packet &P, intr *In );
+
+    /* Get part of light passing through scene media function.
+     * ARGUMENTS:
+     *   - segment start and direction:
+     *       const ray &R;
+     *   - segment length:
+     *       double Dist;
+     * RETURNS:
+     *   (double) transmittance.
+     */
+    double Transmittance( const ray &R, double Dist );
+
+    /* Get last tiles run statistics function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (const tile_scheduler::stats &) statistics.
+     */
+    const tile_scheduler::stats & GetTileStats( void ) const
+    {
+      return Scheduler.GetStats();
+    } /* End of 'GetTileStats' function */
+
     /* Add shape to scene operator function.
      * ARGUMENTS:
      *   - pointer to shape to add:
@@ -0,0 +1,219 @@
+/* PROJECT     : tp5-rt
+ * FILE NAME   : rt_sched.h
+ * PROGRAMMER  : Tim Peterson
+ * LAST UPDATE : 19.10.2026
+ * PURPOSE     : Frame tiles work stealing scheduler.
+ * LICENSE     : MIT License
+ */
+
+#ifndef __rt_sched_h_
+#define __rt_sched_h_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "rt/rt_pool.h"
+
+/* Base project namespace */
+namespace tp5
+{
+  /* Frame tiles scheduler representation type.
+   * Tiles go along Hilbert curve, so neighbouring tiles (and their
+   * geometry) are rendered one after another. Every worker gets
+   * contiguous part of the curve in its own deque, takes tiles from the
+   * front and, when it runs dry, steals from the back of other deques.
+   * With focus point tiles go by distance to it instead and are dealt to
+   * workers in turn, so all workers start near focus and steal far tiles.
+   */
+  class tile_scheduler
+  {
+  public:
+    /* Frame rectangle to render */
+    struct tile
+    {
+      int X0, Y0, W, H; // Corner and size in pixels
+    }; /* End of 'tile' structure */
+
+    /* Last run statistics */
+    struct stats
+    {
+      double Wall = 0;     // Run time in milliseconds
+      double Tail = 0;     // Time from first worker going idle to end in milliseconds
+      stock<double> Busy;  // Per worker tile working time in milliseconds
+      stock<int> Tiles;    // Per worker number of tiles done
+      stock<int> Steals;   // Per worker number of stolen tiles
+    }; /* End of 'stats' structure */
+
+  private:
+    /* Worker own tiles queue */
+    struct worker
+    {
+      std::mutex Lock;       // Queue lock
+      std::deque<int> Queue; // Tile numbers, own end is front
+    }; /* End of 'worker' structure */
+
+    stock<tile> Tiles;   // Tiles in Hilbert curve (or focus distance) order
+    stats Stats;         // Last run statistics
+    bool IsRings = false; // Tiles are dealt to workers in turn flag
+
+    /* Hilbert curve point by distance along curve function.
+     * ARGUMENTS:
+     *   - curve side (power of 2):
+     *       int N;
+     *   - distance along curve:
+     *       int D;
+     *   - point to fill:
+     *       int &X, &Y;
+     * RETURNS: None.
+     */
+    static void Hilbert( int N, int D, int &X, int &Y )
+    {
+      X = Y = 0;
+      for (int s = 1; s < N; s *= 2, D /= 4)
+      {
+        int rx = 1 & (D / 2), ry = 1 & (D ^ rx);
+
+        if (ry == 0)
+        {
+          if (rx == 1)
+            X = s - 1 - X, Y = s - 1 - Y;
+          std::swap(X, Y);
+        }
+        X += s * rx;
+        Y += s * ry;
+      }
+    } /* End of 'Hilbert' function */
+
+  public:
+    /* Cut frame to tiles function.
+     * ARGUMENTS:
+     *   - frame size:
+     *       int W, H;
+     *   - tile side:
+     *       int Size;
+     *   - point to render first, may be nullptr:
+     *       const vec2 *Focus;
+     * RETURNS: None.
+     */
+    void Cut( int W, int H, int Size, const vec2 *Focus = nullptr )
+    {
+      int tw = (W + Size - 1) / Size, th = (H + Size - 1) / Size, n = 1;
+
+      while (n < tw || n < th)
+        n *= 2;
+      Tiles.clear();
+      for (int d = 0; d < n * n; d++)
+      {
+        int x, y;
+
+        Hilbert(n, d, x, y);
+        if (x < tw && y < th)
+          Tiles << tile {x * Size, y * Size, std::min(Size, W - x * Size), std::min(Size, H - y * Size)};
+      }
+      IsRings = Focus != nullptr;
+      if (Focus != nullptr)
+      {
+        auto dist = [Focus]( const tile &T )
+        {
+          double dx = T.X0 + T.W * 0.5 - Focus->X, dy = T.Y0 + T.H * 0.5 - Focus->Y;
+
+          return dx * dx + dy * dy;
+        };
+
+        std::stable_sort(Tiles.begin(), Tiles.end(), [&]( const tile &A, const tile &B ){ return dist(A) < dist(B); });
+      }
+    } /* End of 'Cut' function */
+
+    /* Render all tiles function.
+     * ARGUMENTS:
+     *   - pool to run workers in (one worker per pool slot):
+     *       thread_pool &Pool;
+     *   - tile work function:
+     *       const std::function<void ( const tile &T )> &Work;
+     *   - stop check, called before taking every tile:
+     *       const std::function<bool ( void )> &IsStop;
+     * RETURNS:
+     *   (bool) true if all tiles are done, false if stopped.
+     */
+    bool Run( thread_pool &Pool, const std::function<void ( const tile &T )> &Work, const std::function<bool ( void )> &IsStop )
+    {
+      using clock = std::chrono::steady_clock;
+      auto ms = []( clock::duration D ){ return std::chrono::duration<double, std::milli>(D).count(); };
+      int Threads = Pool.Size();
+      std::unique_ptr<worker[]> ws(new worker[Threads]);
+      stock<clock::time_point> idle;
+      clock::time_point start = clock::now();
+      std::atomic_bool isstopped = false;
+
+      Stats.Busy.assign(Threads, 0);
+      Stats.Tiles.assign(Threads, 0);
+      Stats.Steals.assign(Threads, 0);
+      idle.assign(Threads, start);
+      for (int i = 0; i < (int)Tiles.size(); i++)
+        ws[IsRings ? i % Threads : (long long)i * Threads / Tiles.size()].Queue.push_back(i);
+
+      Pool.Run(
+        [&]( int w )
+        {
+          while (true)
+          {
+            int t = -1;
+
+            if (isstopped || IsStop())
+            {
+              isstopped = true;
+              break;
+            }
+            {
+              std::lock_guard<std::mutex> lg(ws[w].Lock);
+
+              if (!ws[w].Queue.empty())
+                t = ws[w].Queue.front(), ws[w].Queue.pop_front();
+            }
+            for (int k = 1; t == -1 && k < Threads; k++)
+            {
+              worker &v = ws[(w + k) % Threads];
+              std::lock_guard<std::mutex> lg(v.Lock);
+
+              if (!v.Queue.empty())
+                t = v.Queue.back(), v.Queue.pop_back(), Stats.Steals[w]++;
+            }
+            if (t == -1)
+              break;
+
+            clock::time_point t0 = clock::now();
+
+            Work(Tiles[t]);
+            Stats.Busy[w] += ms(clock::now() - t0);
+            Stats.Tiles[w]++;
+          }
+          idle[w] = clock::now();
+        });
+
+      clock::time_point end = clock::now();
+
+      Stats.Wall = ms(end - start);
+      Stats.Tail = ms(end - *std::min_element(idle.begin(), idle.end()));
+      return !isstopped;
+    } /* End of 'Run' function */
+
+    /* Get last run statistics function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (const stats &) statistics.
+     */
+    const stats & GetStats( void ) const
+    {
+      return Stats;
+    } /* End of 'GetStats' function */
+  }; /* End of 'tile_scheduler' class */
+} /* end of 'tp5' namespace */
+
+#endif /* __rt_sched_h_ */
+
+/* END OF 'rt_sched.h' FILE */
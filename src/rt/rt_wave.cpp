@@ -0,0 +1,187 @@
+/* PROJECT     : tp5-rt
+ * FILE NAME   : rt_wave.cpp
+ * PROGRAMMER  : Tim Peterson
+ * LAST UPDATE : 19.10.2026
+ * PURPOSE     : 'scene' wavefront integrator methods defenition file.
+ * LICENSE     : MIT License
+ */
+
+#include <algorithm>
+#include <tuple>
+#include <typeinfo>
+
+#include "rt_scene.h"
+
+/* Trace frame tile by ray waves function.
+ * Primary rays go through pixel centers.
+ * ARGUMENTS:
+ *   - camera for rendering:
+ *       const camera &Cam;
+ *   - tile corner and size:
+ *       int X0, Y0, W, H;
+ *   - tile colors to fill (row by row):
+ *       stock<vec3> &Colors;
+ *   - tile primary intersections to fill, may be nullptr:
+ *       intr *Hits;
+ * RETURNS: None.
+ */
+void tp5::scene::TraceWave( const camera &Cam, int X0, int Y0, int W, int H, stock<vec3> &Colors, intr *Hits )
+{
+  stock<wave_ray> wave;
+
+  /* Primary wave in 4 x 4 tiles, so consecutive rays make good packets */
+  wave.reserve(W * H);
+  for (int y0 = 0; y0 < H; y0 += 4)
+    for (int x0 = 0; x0 < W; x0 += 4)
+      for (int y = y0; y < std::min(y0 + 4, H); y++)
+        for (int x = x0; x < std::min(x0 + 4, W); x++)
+          wave << wave_ray {Cam.FrameRay(X0 + x + 0.5, Y0 + y + 0.5), vec3(1), y * W + x, 0};
+  TraceWave(Cam, wave, W * H, Colors, Hits);
+} /* End of 'tp5::scene::TraceWave' function */
+
+/* Trace primary rays by waves function.
+ * Every wave is intersected in packets of consecutive rays, hits are sorted
+ * by shape type, material and shape, then shaded. Shading adds local
+ * light to pixels, emits light visibility queries (transmittance through
+ * media) and reflection and refraction rays of the next wave. Result is
+ * the same as of recursive 'Trace' up to summation order.
+ * Ray weights sum up in pixel colors, so n samples of pixel with 1 / n
+ * weight give mean color.
+ * ARGUMENTS:
+ *   - camera for rendering:
+ *       const camera &Cam;
+ *   - primary wave (all rays start at camera, cleared after tracing):
+ *       stock<wave_ray> &Wave;
+ *   - number of pixels:
+ *       int N;
+ *   - pixels colors to fill:
+ *       stock<vec3> &Colors;
+ *   - pixels primary intersections to fill, may be nullptr:
+ *       intr *Hits;
+ * RETURNS: None.
+ */
+void tp5::scene::TraceWave( const camera &Cam, stock<wave_ray> &Wave, int N, stock<vec3> &Colors, intr *Hits )
+{
+  stock<wave_ray> &wave = Wave;
+  stock<wave_ray> next;
+  stock<wave_shadow> shadows;
+  stock<intr> hits;
+  stock<std::tuple<size_t, const material *, shape *, int>> order;
+  auto zero = []( const vec3 &V ){ return V.X == 0 && V.Y == 0 && V.Z == 0; };
+
+  Colors.assign(N, vec3(0));
+  while (!wave.empty())
+  {
+    /* Intersection stage */
+    hits.resize(wave.size());
+    for (size_t i = 0; i < wave.size(); i += ray_packet::Size)
+    {
+      ray_packet pk;
+      int n = (int)std::min(wave.size() - i, (size_t)ray_packet::Size);
+
+      for (int k = 0; k < n; k++)
+        pk << wave[i + k].R;
+      pk.Prepare(wave[i].Depth == 0 ? &Cam.Loc : nullptr);
+      IntersectPacket(pk, &hits[i]);
+    }
+    if (Hits != nullptr && wave[0].Depth == 0)
+      for (size_t i = 0; i < wave.size(); i++)
+        Hits[wave[i].Pixel] = hits[i];
+
+    /* Sort stage: misses go straight to background */
+    order.clear();
+    for (size_t i = 0; i < wave.size(); i++)
+      if (hits[i].Shp != nullptr)
+      {
+        shape *shp = hits[i].Shp;
+
+        order << std::make_tuple(typeid(*shp).hash_code(), &shp->GetMaterial(&hits[i]), shp, (int)i);
+      }
+      else
+        Colors[wave[i].Pixel] += wave[i].W * BackgroundColor;
+    std::sort(order.begin(), order.end());
+
+    /* Shading stage, same terms as in 'Shade' */
+    next.clear();
+    shadows.clear();
+    for (auto &o : order)
+    {
+      const wave_ray &wr = wave[std::get<3>(o)];
+      intr *In = &hits[std::get<3>(o)];
+      const ray &R = wr.R;
+      const material &Mtl = *std::get<1>(o);
+
+      In->P = R(In->T);
+      In->Shp->GetNormal(In);
+      if (In->Shp->IsVolume())
+      {
+        vec3 albedo = In->Shp->Color(In);
+
+        Colors[wr.Pixel] += wr.W * Mtl.Ka * AmbientColor;
+        for (auto lg : Lights)
+        {
+          light_info li;
+          double sh = min(max(0.0, lg->Shadow(In->P, &li)), 1.0);
+
+          if (sh > 0)
+            shadows << wave_shadow {ray(In->P, li.Direction), li.Dist, wr.W * albedo * li.Color * sh, wr.Pixel};
+        }
+        continue;
+      }
+
+      vec3 N = In->N;
+
+      N.Normalize();
+      double vn = R.Dir & N;
+      bool IsEnter = true;
+
+      if (vn > 0)
+      {
+        N = -N, vn = -vn;
+        IsEnter = false;
+      }
+      vec3 Ref = R.Dir.Reflect(N), Kd = In->Shp->Color(In);
+
+      Colors[wr.Pixel] += wr.W * Mtl.Ka * AmbientColor;
+      for (auto lg : Lights)
+      {
+        light_info li;
+        double sh = min(max(0.0, lg->Shadow(In->P, &li)), 1.0);
+        vec3 c = vec3(0);
+
+        if (sh <= 0)
+          continue;
+        if (double nl = N & li.Direction; nl > Trashold)
+        {
+          c += Kd * li.Color * nl * sh;
+          if (double rl = Ref & li.Direction; rl > Trashold)
+            c += Mtl.Ks * li.Color * pow(rl, Mtl.Ph) * sh;
+        }
+        if (!zero(c))
+          shadows << wave_shadow {ray(In->P, li.Direction), li.Dist, wr.W * c, wr.Pixel};
+      }
+
+      /* Next wave, rays past max depth would give black */
+      if (wr.Depth + 1 > MaxRecDepth)
+        continue;
+      if (!zero(Mtl.Kr))
+        next << wave_ray {ray(In->P + N * Trashold, Ref), wr.W * Mtl.Kr, wr.Pixel, wr.Depth + 1};
+      if (!zero(Mtl.Kt))
+      {
+        double
+          eta = IsEnter ? Mtl.RefractionCoef / Air : Air / Mtl.RefractionCoef,
+          sq = 1 - (1 - (R.Dir & N) * (R.Dir & N));
+        vec3 T = (R.Dir - N * (R.Dir & N)) * eta - (sq > 0 ? N * sqrt(sq) : N);
+
+        next << wave_ray {ray(In->P + T * Trashold, T), wr.W * Mtl.Kt, wr.Pixel, wr.Depth + 1};
+      }
+    }
+
+    /* Light visibility stage, only media can dim light here */
+    for (auto &s : shadows)
+      Colors[s.Pixel] += s.C * (Volumes.empty() ? 1 : Transmittance(s.R, s.D));
+    wave.swap(next);
+  }
+} /* End of 'tp5::scene::TraceWave' function */
+
+/* END OF 'rt_wave.cpp' FILE */
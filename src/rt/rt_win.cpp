@@ -6,6 +6,7 @@
  * LICENSE     : MIT License
  */
 
+#include <algorithm>
 #include <iostream>
 #include <cstdlib>
 #include <ctime>
@@ -13,6 +14,32 @@
 
 #include "rt_win.h"
 
+/* Navigation key mask function.
+ * ARGUMENTS:
+ *   - key:
+ *       SDL_Keycode Key;
+ * RETURNS:
+ *   (tp5::dword) key bit in 'rt_win::Keys', 0 for other keys.
+ */
+static tp5::dword NavKey( SDL_Keycode Key )
+{
+  switch (Key)
+  {
+  case SDLK_UP:
+    return 1;
+  case SDLK_DOWN:
+    return 2;
+  case SDLK_LEFT:
+    return 4;
+  case SDLK_RIGHT:
+    return 8;
+  case SDLK_PAGEUP:
+    return 16;
+  case SDLK_PAGEDOWN:
+    return 32;
+  }
+  return 0;
+} /* End of 'NavKey' function */
 
 /* rt_win constructor function.
  * ARGUMENTS:
@@ -42,12 +69,10 @@ tp5::rt_win::rt_win( int W, int H ) : window(W, H), Frm(W, H)
 /* 'rt_win' class destructor */
 tp5::rt_win::~rt_win()
 {
-  if (this->Scene.IsRenderActive)
+  if (this->Scene.Job.IsActive())
   {
-    this->Scene.IsToBeStop = true;
     std::cout << "\nWait render thread finishing...\n";
-    while (!this->Scene.IsReadyToFinish)
-      ;
+    this->Scene.Job.Stop();
   }
   std::cout << "\nFinished\n";
 } /* End of 'rt_win' destructor */
@@ -73,6 +98,48 @@ void tp5::rt_win::Render( void )
   //Scene.Render(Cam, Frm);
 } /* End of 'tp5::rt_win::Render' function */
 
+/* Apply gathered navigation input to camera function.
+ * ARGUMENTS:
+ *   - time of held keys motion in seconds:
+ *       double Dt;
+ * RETURNS: None.
+ */
+void tp5::rt_win::Navigate( double Dt )
+{
+  vec3 v = Cam.Loc - Cam.At, at = Cam.At, move = vec3(0);
+  double r = !v;
+
+  /* Orbit in spherical angles, elevation stays off the poles */
+  if (OrbitX != 0 || OrbitY != 0)
+  {
+    double
+      az = atan2(v.X, v.Z) - OrbitX * 0.005,
+      el = std::clamp(asin(v.Y / r) + OrbitY * 0.005, -PI / 2 + 0.01, PI / 2 - 0.01);
+
+    v = vec3(cos(el) * sin(az), sin(el), cos(el) * cos(az)) * r;
+  }
+  v *= pow(0.9, Zoom);
+
+  /* Pan keeps point under cursor, keys fly at one distance to point of interest per second */
+  at += (Cam.Right * -PanX + Cam.Up * PanY) * (r * Cam.PixelAngle());
+  if (Keys & 1)
+    move += Cam.Dir;
+  if (Keys & 2)
+    move -= Cam.Dir;
+  if (Keys & 4)
+    move -= Cam.Right;
+  if (Keys & 8)
+    move += Cam.Right;
+  if (Keys & 16)
+    move += vec3(0, 1, 0);
+  if (Keys & 32)
+    move -= vec3(0, 1, 0);
+  at += move * (r * Dt);
+
+  Cam.SetLocAtUp(at + v, at);
+  OrbitX = OrbitY = PanX = PanY = Zoom = 0;
+} /* End of 'tp5::rt_win::Navigate' function */
+
 /* WM_SIZE window message handle function.
  * ARGUMENTS:
  *   - new width and height of client area:
@@ -81,7 +148,8 @@ void tp5::rt_win::Render( void )
  */
 void tp5::rt_win::OnSize( int W, int H )
 {
-  Scene.IsToBeStop = true;
+  /* Frame must not be resized under render threads, they stop at next tile */
+  Scene.Job.Stop();
   Resize(W, H);
 } /* End of 'tp5::rt_win::OnSize' function */
 
@@ -95,24 +163,32 @@ void tp5::rt_win::OnKeyDown( SDL_Keysym KeySym )
 { 
   Render();
   printf("KeyDown");
-  
+
+  if (dword k = NavKey(KeySym.sym); k != 0)
+  {
+    Keys |= k;
+    return;
+  }
   switch(KeySym.sym)
   {
   case SDLK_ESCAPE:
     window::running = false;
     return;
+  case SDLK_f:
+    IsFoveated = !IsFoveated;
+    std::cout << std::endl << "Foveated render " << (IsFoveated ? "on" : "off") << std::endl;
+    return;
   case SDLK_r:
-    if (!Scene.IsRenderActive)
-    {
-      Scene.IsRenderActive = true;
-      Scene.IsToBeStop = false;
-      Scene.IsReadyToFinish = false;
-      std::cout << std::endl << "Start render scene" << std::endl;
-      std::thread Th;
-      Th = std::thread(
+  {
+    int mx, my;
+
+    /* Focus is under cursor, or at frame center if cursor is out of window */
+    SDL_GetMouseState(&mx, &my);
+    vec2 focus = mx >= 0 && my >= 0 && mx < Cam.FrameW && my < Cam.FrameH ? vec2(mx, my) : vec2(Cam.FrameW / 2, Cam.FrameH / 2);
+
+    if (Scene.RenderAsync(Cam, Frm, scene::render_mode::FINAL,
         [&]( void )
         {
-          Scene.Render(Cam, Frm);
           window::DrawFrame(Frm);
           
           clock_t tt = clock();
@@ -121,16 +197,70 @@ void tp5::rt_win::OnKeyDown( SDL_Keysym KeySym )
  
           
           std::cout << "Render finish <~~~> Time: " << Seconds << "sssss" << std::endl;
+        }, IsFoveated ? &focus : nullptr))
+      std::cout << std::endl << "Start render scene" << std::endl;
+    return;
+  }
+  case SDLK_p:
+    if (Scene.Job.IsActive())
+      Scene.Job.Cancel();
+    else if (StartProgressive())
+      std::cout << std::endl << "Start progressive render (P to stop)" << std::endl;
+    return;
+  case SDLK_s:
+    Writer.Write(Frm, "output.png");
+    return;
+  case SDLK_h:
+    Frm.SaveHdr("output.pfm");
+    return;
+  case SDLK_t:
+  case SDLK_g:
+  case SDLK_EQUALS:
+  case SDLK_MINUS:
+    if (!Scene.Job.IsActive())
+    {
+      const char *names[] = {"Clamp", "Reinhard", "ACES"};
+      frame::develop_params dp = Frm.GetDevelop();
 
-          Scene.IsRenderActive = false;
-          Scene.IsToBeStop = false;
-          Scene.IsReadyToFinish = true;
-        });
-      Th.detach();
+      if (KeySym.sym == SDLK_t)
+        dp.tone = (frame::tonemap)(((int)dp.tone + 1) % 3);
+      else if (KeySym.sym == SDLK_g)
+        dp.srgb = !dp.srgb;
+      else
+        dp.exposure *= KeySym.sym == SDLK_EQUALS ? 1.4142f : 0.7071f;
+      Frm.SetDevelop(dp);
+      window::DrawFrame(Frm);
+      std::cout << std::endl << names[(int)dp.tone] << " tonemap, exposure " << dp.exposure << (dp.srgb ? ", sRGB" : ", linear") << std::endl;
     }
     return;
-  case SDLK_s:
-    Frm.Save("output.png");
+  case SDLK_w:
+    if (!Scene.Job.IsActive())
+    {
+      bool wave = Scene.Integrator == scene::integrator::WAVEFRONT;
+
+      Scene.Integrator = wave ? scene::integrator::RECURSIVE : scene::integrator::WAVEFRONT;
+      std::cout << std::endl << (wave ? "Recursive" : "Wavefront") << " integrator" << std::endl;
+    }
+    return;
+  case SDLK_a:
+    if (!Scene.Job.IsActive())
+    {
+      const char *names[] = {"No", "Uniform", "Adaptive"};
+      int aa = ((int)Scene.Antialias + 1) % 3;
+
+      Scene.Antialias = (scene::antialias)aa;
+      std::cout << std::endl << names[aa] << " anti-aliasing" << std::endl;
+    }
+    return;
+  case SDLK_n:
+    if (!Scene.Job.IsActive())
+    {
+      const char *names[] = {"Random", "Sobol", "Halton", "Blue noise"};
+      int k = ((int)Scene.Sampling + 1) % 4;
+
+      Scene.Sampling = (sampler::kind)k;
+      std::cout << std::endl << names[k] << " sampling" << std::endl;
+    }
     return;
   case SDLK_0:
     Frm.Clear(0x00FF00FF);
@@ -141,9 +271,85 @@ void tp5::rt_win::OnKeyDown( SDL_Keysym KeySym )
   }
 } /* End of 'tp5::rt_win::OnKeyDown' function */
 
+/* On key up call-back method.
+ * ARGUMENTS:
+ *   - released key:
+ *       SDL_Keysym KeySym;
+ * RETURNS: None.
+ */
+void tp5::rt_win::OnKeyUp( SDL_Keysym KeySym )
+{
+  Keys &= ~NavKey(KeySym.sym);
+} /* End of 'tp5::rt_win::OnKeyUp' function */
+
+/* On mouse move call-back method.
+ * ARGUMENTS:
+ *   - cursor shift in pixels:
+ *       int Dx, Dy;
+ *   - pressed buttons mask:
+ *       dword Buttons;
+ * RETURNS: None.
+ */
+void tp5::rt_win::OnMouseMove( int Dx, int Dy, dword Buttons )
+{
+  if (Buttons & SDL_BUTTON_LMASK)
+    OrbitX += Dx, OrbitY += Dy;
+  else if (Buttons & SDL_BUTTON_RMASK)
+    PanX += Dx, PanY += Dy;
+} /* End of 'tp5::rt_win::OnMouseMove' function */
+
+/* On mouse wheel call-back method.
+ * ARGUMENTS:
+ *   - wheel turn:
+ *       int Dz;
+ * RETURNS: None.
+ */
+void tp5::rt_win::OnMouseWheel( int Dz )
+{
+  Zoom += Dz;
+} /* End of 'tp5::rt_win::OnMouseWheel' function */
+
+/* Start progressive render function.
+ * ARGUMENTS: None.
+ * RETURNS:
+ *   (bool) true if started, false if other render is running.
+ */
+bool tp5::rt_win::StartProgressive( void )
+{
+  return Scene.RenderAsync(Cam, Frm, scene::render_mode::PROGRESSIVE,
+    [&]( void )
+    {
+      std::cout << "Progressive render stopped after " << Scene.Passes << " passes" << std::endl;
+    });
+} /* End of 'tp5::rt_win::StartProgressive' function */
+
+/* Execute as fast as possible call-back method.
+ * Gathered navigation input restarts coarse to fine preview, or running
+ * progressive render from new view. Input is applied after coarsest
+ * level of previous preview is done (or 50 ms passed), so fast mouse
+ * still gives whole frames.
+ * ARGUMENTS: None.
+ * RETURNS: None.
+ */
 void tp5::rt_win::OnIdle( void )
 {
+  dword t = SDL_GetTicks();
+
+  if ((OrbitX != 0 || OrbitY != 0 || PanX != 0 || PanY != 0 || Zoom != 0 || Keys != 0) &&
+      (Scene.PreviewStep != 0 || !Scene.Job.IsActive() || t - LastMove >= 50))
+  {
+    bool isprogressive = Scene.Job.IsActive() && Scene.Mode == scene::render_mode::PROGRESSIVE;
+
+    /* Camera must not change under render threads, they stop at next tile */
+    Scene.Job.Stop();
+    Navigate(std::min(t - LastMove, (dword)50) / 1000.0);
+    LastMove = t;
+    if (isprogressive)
+      StartProgressive();
+    else
+      Scene.RenderAsync(Cam, Frm, scene::render_mode::PREVIEW);
+  }
   window::DrawFrame(this->Frm);
-}
+} /* End of 'tp5::rt_win::OnIdle' function */
 
 /* END OF 'rt_win.cpp' FILE */
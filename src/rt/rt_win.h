@@ -10,6 +10,7 @@
 #define __rt_win_h_
 
 #include "win/win.h"
+#include "frame/writer.h"
 #include "rt_scene.h"
 
 /* Base project namespace */
@@ -22,6 +23,17 @@ namespace tp5
     frame  Frm;   // frame for rendering to window
     camera Cam;   // Camera raytracing
     scene  Scene; // Scene to render
+    image_writer Writer; // Saves frames in background
+
+    /* Camera navigation input gathered since last camera change */
+    int
+      OrbitX = 0, OrbitY = 0, // Left button drag: turn around point of interest
+      PanX = 0, PanY = 0,     // Right button drag: shift in view plane
+      Zoom = 0;               // Wheel: move to or from point of interest
+    dword
+      Keys = 0,               // Held navigation keys mask
+      LastMove = 0;           // Last camera change time in milliseconds
+    bool IsFoveated = false;  // Final render starts from area under cursor flag
 
     /* 'rt_win' class constructor */
     rt_win( int W, int H );
@@ -43,6 +55,21 @@ namespace tp5
      */
     void Render( void );
 
+    /* Apply gathered navigation input to camera function.
+     * ARGUMENTS:
+     *   - time of held keys motion in seconds:
+     *       double Dt;
+     * RETURNS: None.
+     */
+    void Navigate( double Dt );
+
+    /* Start progressive render function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (bool) true if started, false if other render is running.
+     */
+    bool StartProgressive( void );
+
     /* WM_SIZE window message handle function.
      * ARGUMENTS:
      *   - new width and height of client area:
@@ -59,6 +86,32 @@ namespace tp5
      */
     void OnKeyDown( SDL_Keysym KeySym ) override;
 
+    /* On key up call-back method.
+     * ARGUMENTS:
+     *   - released key:
+     *       SDL_Keysym KeySym;
+     * RETURNS: None.
+     */
+    void OnKeyUp( SDL_Keysym KeySym ) override;
+
+    /* On mouse move call-back method.
+     * ARGUMENTS:
+     *   - cursor shift in pixels:
+     *       int Dx, Dy;
+     *   - pressed buttons mask:
+     *       dword Buttons;
+     * RETURNS: None.
+     */
+    void OnMouseMove( int Dx, int Dy, dword Buttons ) override;
+
+    /* On mouse wheel call-back method.
+     * ARGUMENTS:
+     *   - wheel turn:
+     *       int Dz;
+     * RETURNS: None.
+     */
+    void OnMouseWheel( int Dz ) override;
+
     /* Execute as fast as possible call-back method.
      * ARGUMENTS: None.
      * RETURNS: None.
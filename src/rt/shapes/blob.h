@@ -0,0 +1,401 @@
+/* PROJECT     : tp5-rt
+ * FILE NAME   : blob.h
+ * PROGRAMMER  : Tim Peterson
+ * LAST UPDATE : 19.10.2026
+ * PURPOSE     : Blobby (metaball) surface shape defenition file.
+ * LICENSE     : MIT License
+ */
+
+#ifndef __blob_h_
+#define __blob_h_
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+#include "mth/mth_simd.h"
+#include "rt/rt_bvh.h"
+#include "shape.h"
+
+/* Base project namespace */
+namespace tp5
+{
+  /* Blobby surface representation class.
+   * Surface is the iso level of field sum(W * (1 - d^2 / R^2)^3) over
+   * sources, where d < R. Only sources whose influence spheres are crossed
+   * by the ray are found (by own BVH) and evaluated. Overlapping sources are
+   * grouped into spans along the ray. Spans are stepped by distance to level
+   * divided by field slope bound of sources near the step, but not less than
+   * 1/128 of max step, the root is refined by bisection. Only a grazing pair
+   * of crossings closer than that minimal step can be skipped.
+   * Single source of weight 1 with level 0.5 looks like a sphere of radius
+   * 0.454 * R.
+   */
+  class blob : public shape
+  {
+  private:
+    stock<float> CX, CY, CZ, Rad, W; // Sources centers, radiuses and weights
+    double Level;                    // Iso level
+    bvh Bvh;                         // Hierarchy over influence spheres
+    std::atomic_bool IsBuilt;        // Hierarchy is up to date flag
+    std::mutex BuildMutex;           // Hierarchy building lock
+
+    /* Source crossed by ray */
+    struct cand
+    {
+      double T0, T1, B, H2; // Influence interval, closest approach distance and squared distance
+      int I;                // Source index
+    }; /* End of 'cand' structure */
+
+    /* Span of sources prepared for field sampling (relative to span start) */
+    struct span
+    {
+      stock<float>
+        B, H, IR2, W,            // Closest approach, squared distance / R^2, 1 / R^2, weight
+        T0, T1, L;               // Influence interval and slope bound along ray
+      int N;                     // Number of sources
+
+      /* Evaluate field along ray function.
+       * ARGUMENTS:
+       *   - distance from span start:
+       *       float T;
+       * RETURNS:
+       *   (float) field value.
+       */
+      float Field( float T ) const
+      {
+        using mth::simd4;
+        simd4 t(T), one(1.0f), zero(0.0f), acc(0.0f);
+        float s[4];
+
+        for (int i = 0; i < N; i += 4)
+        {
+          simd4
+            x = t - simd4::Load(&B[i]),
+            u = Max(one - simd4::Load(&H[i]) - simd4::Load(&IR2[i]) * x * x, zero);
+
+          acc = acc + simd4::Load(&W[i]) * u * u * u;
+        }
+        acc.Store(s);
+        return s[0] + s[1] + s[2] + s[3];
+      } /* End of 'Field' function */
+
+      /* Evaluate field slope bound on segment function.
+       * ARGUMENTS:
+       *   - segment along ray:
+       *       float Ta, Tb;
+       * RETURNS:
+       *   (float) max field derivative bound.
+       */
+      float Slope( float Ta, float Tb ) const
+      {
+        using mth::simd4;
+        simd4 ta(Ta), tb(Tb), zero(0.0f), acc(0.0f);
+        float s[4];
+
+        for (int i = 0; i < N; i += 4)
+          acc = acc + Select((simd4::Load(&T0[i]) < tb).And(simd4::Load(&T1[i]) > ta), simd4::Load(&L[i]), zero);
+        acc.Store(s);
+        return s[0] + s[1] + s[2] + s[3];
+      } /* End of 'Slope' function */
+    }; /* End of 'span' structure */
+
+    /* Build hierarchy function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    void Build( void )
+    {
+      const std::lock_guard<std::mutex> lock(BuildMutex);
+
+      if (IsBuilt)
+        return;
+
+      Bvh.Build((int)Rad.size(),
+        [&]( int I )
+        {
+          fvec3 c(CX[I], CY[I], CZ[I]), r(Rad[I]);
+
+          return aabb(c - r, c + r);
+        });
+      Bvh.Reorder(CX), Bvh.Reorder(CY), Bvh.Reorder(CZ), Bvh.Reorder(Rad), Bvh.Reorder(W);
+      Bvh.Index = stock<int>();
+      IsBuilt = true;
+    } /* End of 'Build' function */
+
+    /* Find first level crossing in span function.
+     * ARGUMENTS:
+     *   - prepared span:
+     *       const span &S;
+     *   - span length:
+     *       float Len;
+     *   - max step:
+     *       float Step;
+     *   - found distance from span start:
+     *       float &T;
+     * RETURNS:
+     *   (bool) true if level is crossed.
+     */
+    bool SpanRoot( const span &S, float Len, float Step, float &T ) const
+    {
+      float
+        lv = (float)Level,
+        t0 = 0, f0 = S.Field(0) - lv;
+
+      while (t0 < Len)
+      {
+        /* |d(W * u^3) / dt| <= 1.72 * |W| / R, so level is not
+         * crossed closer than |f - level| / slope. Step is kept at least
+         * Step / 128 near the level: single crossing inside it is still
+         * found by sign change, two crossings inside it are missed */
+        float
+          sl = S.Slope(t0, t0 + Step),
+          st = sl > 0 ? std::min(Step, std::max(std::abs(f0) / sl, Step / 128)) : Step,
+          t1 = std::min(t0 + st, Len),
+          f1 = S.Field(t1) - lv;
+
+        if ((f0 > 0) != (f1 > 0))
+        {
+          for (int i = 0; i < 24; i++)
+          {
+            float
+              tm = (t0 + t1) / 2,
+              fm = S.Field(tm) - lv;
+
+            if ((fm > 0) == (f0 > 0))
+              t0 = tm, f0 = fm;
+            else
+              t1 = tm;
+          }
+          T = (t0 + t1) / 2;
+          return true;
+        }
+        t0 = t1, f0 = f1;
+      }
+      return false;
+    } /* End of 'SpanRoot' function */
+
+    /* Visit sources around point function.
+     * ARGUMENTS:
+     *   - point:
+     *       const vec3 &P;
+     *   - visitor, void (int I, const vec3 &D, double R2) where D is P - center:
+     *       Func F;
+     * RETURNS: None.
+     */
+    template<class Func>
+      void ForSources( const vec3 &P, Func F )
+      {
+        if (!IsBuilt)
+          Build();
+        Bvh.Walk(ray(P, vec3(1, 1, 1)), 0,
+          [&]( int First, int Count )
+          {
+            for (int i = First; i < First + Count; i++)
+            {
+              vec3 d = P - vec3(CX[i], CY[i], CZ[i]);
+              double r2 = (double)Rad[i] * Rad[i];
+
+              if ((d & d) < r2)
+                F(i, d, r2);
+            }
+          });
+      } /* End of 'ForSources' function */
+
+  public:
+    /* 'blob' class constructor function.
+     * ARGUMENTS:
+     *   - iso level:
+     *       double Lev;
+     *   - material:
+     *       const material &M;
+     */
+    blob( double Lev = 0.5, const material &M = material() ) : shape(M), Level(Lev), IsBuilt(false)
+    {
+    } /* End of 'blob' function */
+
+    /* Reserve memory for sources function.
+     * ARGUMENTS:
+     *   - expected number of sources:
+     *       size_t N;
+     * RETURNS: None.
+     */
+    void Reserve( size_t N )
+    {
+      CX.reserve(N), CY.reserve(N), CZ.reserve(N), Rad.reserve(N), W.reserve(N);
+    } /* End of 'Reserve' function */
+
+    /* Add field source function (not while rendering).
+     * ARGUMENTS:
+     *   - center and influence radius:
+     *       const vec3 &C, double R;
+     *   - weight (negative ones carve the surface):
+     *       double Weight;
+     * RETURNS:
+     *   (blob &) self reference.
+     */
+    blob & Add( const vec3 &C, double R, double Weight = 1 )
+    {
+      CX << (float)C.X, CY << (float)C.Y, CZ << (float)C.Z, Rad << (float)R, W << (float)Weight;
+      IsBuilt = false;
+      return *this;
+    } /* End of 'Add' function */
+
+    /* Evaluate field function.
+     * ARGUMENTS:
+     *   - point:
+     *       const vec3 &P;
+     * RETURNS:
+     *   (double) field value.
+     */
+    double Field( const vec3 &P )
+    {
+      double f = 0;
+
+      ForSources(P,
+        [&]( int I, const vec3 &D, double R2 )
+        {
+          double u = 1 - (D & D) / R2;
+
+          f += W[I] * u * u * u;
+        });
+      return f;
+    } /* End of 'Field' function */
+
+    /* Shape intersect virtual function.
+     * ARGUMENTS:
+     *   - ray to intersect with:
+     *       const ray &R;
+     *   - intersection structure:
+     *       intr *Intr;
+     * RETURNS:
+     *   (bool) true if intersected, false otherwise.
+     */
+    bool Intersect( const ray &R, intr *Intr ) override
+    {
+      thread_local stock<cand> cands;
+      thread_local span sp;
+
+      if (!IsBuilt)
+        Build();
+
+      /* Collect crossed influence spheres */
+      cands.clear();
+      Bvh.Walk(R, std::numeric_limits<double>::max(),
+        [&]( int First, int Count )
+        {
+          for (int i = First; i < First + Count; i++)
+          {
+            vec3 oc = vec3(CX[i], CY[i], CZ[i]) - R.Org;
+            double
+              b = oc & R.Dir,
+              r2 = (double)Rad[i] * Rad[i];
+            vec3 q = oc - R.Dir * b;
+            double h2 = q & q;
+
+            if (h2 >= r2)
+              continue;
+
+            double s = sqrt(r2 - h2);
+
+            if (b + s > Trashold)
+              cands.push_back({b - s, b + s, b, h2, i});
+          }
+        });
+      std::sort(cands.begin(), cands.end(), []( const cand &A, const cand &B ){ return A.T0 < B.T0; });
+
+      /* Sample spans of overlapping sources front to back */
+      for (size_t j = 0, k; j < cands.size(); j = k)
+      {
+        double
+          end = cands[j].T1,
+          start = max(cands[j].T0, Trashold);
+        float rmin = Rad[cands[j].I];
+
+        for (k = j + 1; k < cands.size() && cands[k].T0 < end; k++)
+          end = max(end, cands[k].T1), rmin = std::min(rmin, Rad[cands[k].I]);
+
+        sp.N = (int)(k - j);
+        for (auto *a : {&sp.B, &sp.H, &sp.IR2, &sp.W, &sp.T0, &sp.T1, &sp.L})
+          a->resize((sp.N + 3) & ~3);
+        for (int i = 0; i < sp.N; i++)
+        {
+          const cand &c = cands[j + i];
+          double ir2 = 1 / ((double)Rad[c.I] * Rad[c.I]);
+
+          sp.B[i] = (float)(c.B - start);
+          sp.H[i] = (float)(c.H2 * ir2);
+          sp.IR2[i] = (float)ir2;
+          sp.W[i] = W[c.I];
+          sp.T0[i] = (float)(c.T0 - start);
+          sp.T1[i] = (float)(c.T1 - start);
+          sp.L[i] = (float)(1.72 * std::abs(W[c.I]) / Rad[c.I]);
+        }
+        for (int i = sp.N; i < (int)sp.B.size(); i++)
+          sp.B[i] = 0, sp.H[i] = 1, sp.IR2[i] = 0, sp.W[i] = 0, sp.T0[i] = sp.T1[i] = -1, sp.L[i] = 0;
+
+        float t;
+
+        if (SpanRoot(sp, (float)(end - start), rmin / 2, t))
+        {
+          Intr->T = start + t;
+          Intr->Shp = this;
+          return true;
+        }
+      }
+      return false;
+    } /* End of 'Intersect' function */
+
+    /* Get normal at intersection virtual function.
+     * ARGUMENTS:
+     *   - intersection:
+     *       intr *Intr;
+     * RETURNS: None.
+     */
+    void GetNormal( intr *Intr ) override
+    {
+      vec3 g(0);
+
+      /* Field grows inwards, so normal is opposite to gradient,
+       * gradient of each term is -6 * W * u^2 * D / R^2 */
+      ForSources(Intr->P,
+        [&]( int I, const vec3 &D, double R2 )
+        {
+          double u = 1 - (D & D) / R2;
+
+          g += D * (W[I] * u * u / R2);
+        });
+      Intr->N = (g & g) > 0 ? g.Normalizing() : vec3(0, 1, 0);
+    } /* End of 'GetNormal' function */
+
+    /* Get shape bound box function.
+     * ARGUMENTS:
+     *   - box corners to fill:
+     *       vec3 &Min, &Max;
+     * RETURNS:
+     *   (bool) true if shape is bounded, false for infinite shapes.
+     */
+    bool GetBound( vec3 &Min, vec3 &Max ) override
+    {
+      if (!IsBuilt)
+        Build();
+      return Bvh.Bound().Get(Min, Max);
+    } /* End of 'GetBound' function */
+
+    /* Check if point is inside shape function.
+     * ARGUMENTS:
+     *   - point to check:
+     *       const vec3 &P;
+     * RETURNS:
+     *   (bool) true if is inside, false, otherwise
+     */
+    bool IsInside( const vec3 &P ) override
+    {
+      return Field(P) > Level;
+    } /* End of 'IsInside' function */
+  }; /* End of 'blob' class */
+} /* end of 'tp5' namespace */
+
+#endif /* __blob_h_ */
+
+/* END OF 'blob.h' FILE */
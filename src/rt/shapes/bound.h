@@ -57,6 +57,18 @@ namespace tp5
     {
     } /* End of 'GetNormal' function */
 
+    /* Get shape bound box function.
+     * ARGUMENTS:
+     *   - box corners to fill:
+     *       vec3 &Min, &Max;
+     * RETURNS:
+     *   (bool) true if shape is bounded, false for infinite shapes.
+     */
+    bool GetBound( vec3 &Min, vec3 &Max ) override
+    {
+      return Bound->GetBound(Min, Max);
+    } /* End of 'GetBound' function */
+
     /* Check if point is inside shape function.
      * ARGUMENTS:
      *   - point to check:
@@ -84,6 +96,18 @@ namespace tp5
 
       return Shape->AllIntersections(R, IL);
     } /* End of 'AllIntersections' function */
+
+    /* Prepare shape for rendering from camera function.
+     * ARGUMENTS:
+     *   - camera:
+     *       const camera &Cam;
+     * RETURNS: None.
+     */
+    void SetView( const camera &Cam ) override
+    {
+      Shape->SetView(Cam);
+      Bound->SetView(Cam);
+    } /* End of 'SetView' function */
   }; /* End of 'bound' class */
 } /* end of 'tp5' namespace */
 
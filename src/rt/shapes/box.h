@@ -94,6 +94,21 @@ namespace tp5
     {
     } /* End of 'GetNormal' function */
 
+    /* Get shape bound box function.
+     * ARGUMENTS:
+     *   - box corners to fill:
+     *       vec3 &Min, &Max;
+     * RETURNS:
+     *   (bool) true if shape is bounded, false for infinite shapes.
+     */
+    bool GetBound( vec3 &Min, vec3 &Max ) override
+    {
+      /* Intersection accepts points within 'Trashold' of faces */
+      Min = vec3(std::min(P0.X, P1.X), std::min(P0.Y, P1.Y), std::min(P0.Z, P1.Z)) - vec3(Trashold);
+      Max = vec3(std::max(P0.X, P1.X), std::max(P0.Y, P1.Y), std::max(P0.Z, P1.Z)) + vec3(Trashold);
+      return true;
+    } /* End of 'GetBound' function */
+
     /* Check if point is inside shape function.
      * ARGUMENTS:
      *   - point to check:
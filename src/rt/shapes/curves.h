@@ -0,0 +1,473 @@
+/* PROJECT     : tp5-rt
+ * FILE NAME   : curves.h
+ * PROGRAMMER  : Tim Peterson
+ * LAST UPDATE : 19.10.2026
+ * PURPOSE     : Cubic Bezier curves (hair, fibers) shape defenition file.
+ * LICENSE     : MIT License
+ */
+
+#ifndef __curves_h_
+#define __curves_h_
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+#include "rt/rt_bvh.h"
+#include "shape.h"
+
+/* Base project namespace */
+namespace tp5
+{
+  /* Cubic Bezier curves set representation class.
+   * Curves are kept in float SoA arrays (56 bytes per curve): four control
+   * points and radiuses at both ends. Curve is intersected as ribbon facing
+   * the ray or as round tube, by recursive subdivision in ray space. BVH
+   * primitives are parameter ranges of curves: long diagonal or bent curves are
+   * cut while halves boxes hold much less volume, so boxes follow the curve.
+   */
+  class curves : public shape
+  {
+  public:
+    /* Curve cross section kind */
+    enum class mode
+    {
+      RIBBON, // Flat strip facing the ray
+      TUBE    // Round tube
+    }; /* End of 'mode' enumeration */
+
+  private:
+    /* BVH primitive: curve parameter range */
+    struct prim
+    {
+      int Curve;    // Curve number
+      float U0, U1; // Parameter range
+    }; /* End of 'prim' structure */
+
+    /* Found hit */
+    struct hit
+    {
+      int Curve;    // Curve number
+      double U;     // Curve parameter
+    }; /* End of 'hit' structure */
+
+    mode Mode;                 // Cross section kind
+    stock<float> X, Y, Z;      // Control points, 4 per curve
+    stock<float> W;            // Radiuses at ends, 2 per curve
+    stock<prim> Prims;         // Hierarchy primitives
+    bvh Bvh;                   // Hierarchy over primitives
+    std::atomic_bool IsBuilt;  // Hierarchy is up to date flag
+    std::mutex BuildMutex;     // Hierarchy building lock
+
+    /* Get curve control points function.
+     * ARGUMENTS:
+     *   - curve number:
+     *       int C;
+     *   - points to fill:
+     *       vec3 *P;
+     * RETURNS: None.
+     */
+    void Points( int C, vec3 *P ) const
+    {
+      for (int i = 0; i < 4; i++)
+        P[i] = vec3(X[C * 4 + i], Y[C * 4 + i], Z[C * 4 + i]);
+    } /* End of 'Points' function */
+
+    /* Split Bezier curve at half function.
+     * ARGUMENTS:
+     *   - curve:
+     *       const vec3 *P;
+     *   - halves to fill:
+     *       vec3 *A, *B;
+     * RETURNS: None.
+     */
+    static void Split( const vec3 *P, vec3 *A, vec3 *B )
+    {
+      vec3
+        p01 = (P[0] + P[1]) / 2, p12 = (P[1] + P[2]) / 2, p23 = (P[2] + P[3]) / 2,
+        p012 = (p01 + p12) / 2, p123 = (p12 + p23) / 2, m = (p012 + p123) / 2;
+
+      A[0] = P[0], A[1] = p01, A[2] = p012, A[3] = m;
+      B[0] = m, B[1] = p123, B[2] = p23, B[3] = P[3];
+    } /* End of 'Split' function */
+
+    /* Evaluate Bezier curve function.
+     * ARGUMENTS:
+     *   - curve:
+     *       const vec3 *P;
+     *   - parameter:
+     *       double U;
+     *   - derivative to fill (may be nullptr):
+     *       vec3 *D;
+     * RETURNS:
+     *   (vec3) curve point.
+     */
+    static vec3 Eval( const vec3 *P, double U, vec3 *D = nullptr )
+    {
+      vec3
+        a = P[0] + (P[1] - P[0]) * U, b = P[1] + (P[2] - P[1]) * U, c = P[2] + (P[3] - P[2]) * U,
+        d = a + (b - a) * U, e = b + (c - b) * U;
+
+      if (D != nullptr)
+        *D = (e - d) * 3;
+      return d + (e - d) * U;
+    } /* End of 'Eval' function */
+
+    /* Get part of Bezier curve function.
+     * ARGUMENTS:
+     *   - curve:
+     *       const vec3 *P;
+     *   - parameter range:
+     *       double U0, U1;
+     *   - part to fill:
+     *       vec3 *S;
+     * RETURNS: None.
+     */
+    static void Part( const vec3 *P, double U0, double U1, vec3 *S )
+    {
+      /* Blossom: control points are B(u0,u0,u0), B(u0,u0,u1), B(u0,u1,u1), B(u1,u1,u1) */
+      auto blossom = [P]( double A, double B, double C )
+      {
+        vec3
+          a[3] = {P[0] + (P[1] - P[0]) * A, P[1] + (P[2] - P[1]) * A, P[2] + (P[3] - P[2]) * A},
+          b[2] = {a[0] + (a[1] - a[0]) * B, a[1] + (a[2] - a[1]) * B};
+
+        return b[0] + (b[1] - b[0]) * C;
+      };
+
+      S[0] = blossom(U0, U0, U0), S[1] = blossom(U0, U0, U1);
+      S[2] = blossom(U0, U1, U1), S[3] = blossom(U1, U1, U1);
+    } /* End of 'Part' function */
+
+    /* Get primitive bound box function.
+     * ARGUMENTS:
+     *   - primitive:
+     *       const prim &Pr;
+     * RETURNS:
+     *   (aabb) box.
+     */
+    aabb Bound( const prim &Pr ) const
+    {
+      vec3 p[4], s[4];
+      aabb b;
+      float r = std::max(W[Pr.Curve * 2] + (W[Pr.Curve * 2 + 1] - W[Pr.Curve * 2]) * Pr.U0,
+                         W[Pr.Curve * 2] + (W[Pr.Curve * 2 + 1] - W[Pr.Curve * 2]) * Pr.U1);
+
+      Points(Pr.Curve, p);
+      Part(p, Pr.U0, Pr.U1, s);
+      for (auto &v : s)
+        b << fvec3((float)v.X - r, (float)v.Y - r, (float)v.Z - r) << fvec3((float)v.X + r, (float)v.Y + r, (float)v.Z + r);
+      return b;
+    } /* End of 'Bound' function */
+
+    /* Build hierarchy function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    void Build( void )
+    {
+      const std::lock_guard<std::mutex> lock(BuildMutex);
+
+      if (IsBuilt)
+        return;
+
+      /* Cut curves while halves boxes hold much less volume (up to 4 pieces) */
+      auto volume = []( const aabb &B )
+      {
+        fvec3 e = B.B1 - B.B0;
+
+        return e.X * e.Y * e.Z;
+      };
+
+      Prims.clear();
+      for (int c = 0; c < (int)W.size() / 2; c++)
+      {
+        prim stack[4];
+        int sp = 0;
+
+        stack[sp++] = {c, 0, 1};
+        while (sp > 0)
+        {
+          prim p = stack[--sp];
+          float m = (p.U0 + p.U1) / 2;
+          prim a = {c, p.U0, m}, b = {c, m, p.U1};
+
+          if (p.U1 - p.U0 > 0.3f && volume(Bound(a)) + volume(Bound(b)) < 0.5f * volume(Bound(p)))
+            stack[sp++] = b, stack[sp++] = a;
+          else
+            Prims << p;
+        }
+      }
+      Bvh.Build((int)Prims.size(), [&]( int I ){ return Bound(Prims[I]); });
+      Bvh.Reorder(Prims);
+      Bvh.Index = stock<int>();
+      IsBuilt = true;
+    } /* End of 'Build' function */
+
+    /* Intersect curve part in ray space function.
+     * ARGUMENTS:
+     *   - curve in ray space (ray goes along Z from origin):
+     *       const vec3 *P;
+     *   - parameter range and radiuses at its ends:
+     *       double U0, U1, W0, W1;
+     *   - subdivision depth left:
+     *       int Depth;
+     *   - max distance (updated on hit):
+     *       double &TMax;
+     *   - hit to fill:
+     *       hit &H;
+     *   - curve number:
+     *       int C;
+     * RETURNS:
+     *   (bool) true if closer hit is found.
+     */
+    bool Recurse( const vec3 *P, double U0, double U1, double W0, double W1, int Depth,
+                  double &TMax, hit &H, int C ) const
+    {
+      double
+        w = std::max(W0, W1),
+        x0 = std::min({P[0].X, P[1].X, P[2].X, P[3].X}) - w, x1 = std::max({P[0].X, P[1].X, P[2].X, P[3].X}) + w,
+        y0 = std::min({P[0].Y, P[1].Y, P[2].Y, P[3].Y}) - w, y1 = std::max({P[0].Y, P[1].Y, P[2].Y, P[3].Y}) + w,
+        z0 = std::min({P[0].Z, P[1].Z, P[2].Z, P[3].Z}) - w, z1 = std::max({P[0].Z, P[1].Z, P[2].Z, P[3].Z}) + w;
+
+      if (x0 > 0 || x1 < 0 || y0 > 0 || y1 < 0 || z1 < Trashold || z0 > TMax)
+        return false;
+      if (Depth > 0)
+      {
+        vec3 a[4], b[4];
+        double um = (U0 + U1) / 2, wm = (W0 + W1) / 2;
+
+        Split(P, a, b);
+        bool ha = Recurse(a, U0, um, W0, wm, Depth - 1, TMax, H, C);
+
+        return Recurse(b, um, U1, wm, W1, Depth - 1, TMax, H, C) || ha;
+      }
+
+      /* Flat enough: closest point of chord to the ray */
+      double
+        sx = P[3].X - P[0].X, sy = P[3].Y - P[0].Y,
+        l2 = sx * sx + sy * sy,
+        b = P[0].X * sx + P[0].Y * sy,
+        s = l2 > 0 ? std::clamp(-b / l2, 0.0, 1.0) : 0;
+      vec3 p = Eval(P, s);
+      double r = W0 + (W1 - W0) * s, z = p.Z;
+
+      if (p.X * p.X + p.Y * p.Y > r * r)
+        return false;
+      if (Mode == mode::TUBE)
+      {
+        /* Front of swept circles over chord part near the ray */
+        double
+          c = P[0].X * P[0].X + P[0].Y * P[0].Y - r * r,
+          q = l2 > 0 ? sqrt(std::max(b * b - l2 * c, 0.0)) / l2 : 0,
+          s0 = std::max(s - q, 0.0), s1 = std::min(s + q, 1.0);
+
+        for (int k = 0; k <= 4; k++)
+        {
+          vec3 v = Eval(P, s0 + (s1 - s0) * k / 4);
+          double d2 = v.X * v.X + v.Y * v.Y;
+
+          if (d2 < r * r)
+            z = std::min(z, v.Z - sqrt(r * r - d2));
+        }
+        z = std::min(z, p.Z - sqrt(r * r - p.X * p.X - p.Y * p.Y));
+      }
+      if (z < Trashold || z >= TMax)
+        return false;
+      TMax = z;
+      H.Curve = C;
+      H.U = U0 + (U1 - U0) * s;
+      return true;
+    } /* End of 'Recurse' function */
+
+  public:
+    /* 'curves' class constructor function.
+     * ARGUMENTS:
+     *   - cross section kind:
+     *       mode M;
+     *   - material:
+     *       const material &Mt;
+     */
+    curves( mode M = mode::TUBE, const material &Mt = material() ) : shape(Mt), Mode(M), IsBuilt(false)
+    {
+    } /* End of 'curves' function */
+
+    /* Reserve memory for curves function.
+     * ARGUMENTS:
+     *   - expected number of curves:
+     *       size_t N;
+     * RETURNS: None.
+     */
+    void Reserve( size_t N )
+    {
+      X.reserve(N * 4), Y.reserve(N * 4), Z.reserve(N * 4), W.reserve(N * 2);
+    } /* End of 'Reserve' function */
+
+    /* Add curve function (not while rendering).
+     * ARGUMENTS:
+     *   - control points:
+     *       const vec3 &P0, &P1, &P2, &P3;
+     *   - radiuses at start and end:
+     *       double R0, R1;
+     * RETURNS:
+     *   (curves &) self reference.
+     */
+    curves & Add( const vec3 &P0, const vec3 &P1, const vec3 &P2, const vec3 &P3, double R0, double R1 )
+    {
+      for (const vec3 *p : {&P0, &P1, &P2, &P3})
+        X << (float)p->X, Y << (float)p->Y, Z << (float)p->Z;
+      W << (float)R0 << (float)R1;
+      IsBuilt = false;
+      return *this;
+    } /* End of 'Add' function */
+
+    /* Add strand through points function (not while rendering).
+     * ARGUMENTS:
+     *   - points (Catmull-Rom spline through them is added):
+     *       const stock<vec3> &Pts;
+     *   - radiuses at root and tip:
+     *       double R0, R1;
+     * RETURNS:
+     *   (curves &) self reference.
+     */
+    curves & AddStrand( const stock<vec3> &Pts, double R0, double R1 )
+    {
+      int n = (int)Pts.size();
+
+      for (int i = 0; i + 1 < n; i++)
+      {
+        const vec3
+          &a = Pts[std::max(i - 1, 0)], &b = Pts[i],
+          &c = Pts[i + 1], &d = Pts[std::min(i + 2, n - 1)];
+
+        Add(b, b + (c - a) / 6, c - (d - b) / 6, c,
+            R0 + (R1 - R0) * i / (n - 1), R0 + (R1 - R0) * (i + 1) / (n - 1));
+      }
+      return *this;
+    } /* End of 'AddStrand' function */
+
+    /* Shape intersect virtual function.
+     * ARGUMENTS:
+     *   - ray to intersect with:
+     *       const ray &R;
+     *   - intersection structure:
+     *       intr *Intr;
+     * RETURNS:
+     *   (bool) true if intersected, false otherwise.
+     */
+    bool Intersect( const ray &R, intr *Intr ) override
+    {
+      if (!IsBuilt)
+        Build();
+
+      /* Ray space basis */
+      double sg = std::copysign(1.0, R.Dir.Z), a = -1 / (sg + R.Dir.Z), b = R.Dir.X * R.Dir.Y * a;
+      vec3
+        ex(1 + sg * R.Dir.X * R.Dir.X * a, sg * b, -sg * R.Dir.X),
+        ey(b, sg + R.Dir.Y * R.Dir.Y * a, -R.Dir.Y);
+      double tmax = std::numeric_limits<double>::max();
+      hit h = {-1, 0};
+
+      Bvh.Traverse(R, tmax,
+        [&]( int First, int Count, double &TMax ) -> bool
+        {
+          bool found = false;
+
+          for (int i = First; i < First + Count; i++)
+          {
+            const prim &pr = Prims[i];
+            vec3 p[4], s[4];
+            double
+              w0 = W[pr.Curve * 2], w1 = W[pr.Curve * 2 + 1],
+              r0 = w0 + (w1 - w0) * pr.U0, r1 = w0 + (w1 - w0) * pr.U1;
+
+            Points(pr.Curve, p);
+            Part(p, pr.U0, pr.U1, s);
+            for (auto &v : s)
+            {
+              vec3 d = v - R.Org;
+
+              v = vec3(d & ex, d & ey, d & R.Dir);
+            }
+
+            /* Depth from curvature, so chords stay within 5% of width */
+            double l = 0;
+
+            for (int k = 0; k < 2; k++)
+            {
+              vec3 dd = s[k] - s[k + 1] * 2 + s[k + 2];
+
+              l = std::max({l, (double)std::abs(dd.X), (double)std::abs(dd.Y)});
+            }
+            double e = std::max(r0, r1) * 0.05;
+            int depth = l > 0 && e > 0 ? std::clamp((int)std::ceil(std::log2(1.41421356 * 6 * l / (8 * e)) / 2), 0, 10) : 0;
+
+            found |= Recurse(s, pr.U0, pr.U1, r0, r1, depth, TMax, h, pr.Curve);
+          }
+          return found;
+        });
+      if (h.Curve == -1)
+        return false;
+
+      /* Normal: facing the ray for ribbons, around tangent for tubes */
+      vec3 p[4], d, c;
+      double
+        w0 = W[h.Curve * 2], w1 = W[h.Curve * 2 + 1],
+        r = w0 + (w1 - w0) * h.U;
+
+      Points(h.Curve, p);
+      c = Eval(p, h.U, &d);
+      d = (d & d) > 0 ? d.Normalizing() : R.Dir % ex;
+
+      vec3
+        f = -R.Dir + d * (R.Dir & d),
+        side = d % R.Dir;
+
+      f = (f & f) > 0 ? f.Normalizing() : -R.Dir;
+      side = (side & side) > 0 ? side.Normalizing() : ex;
+      Intr->T = tmax;
+      if (Mode == mode::TUBE && r > 0)
+      {
+        double v = std::clamp(((R(tmax) - c) & side) / r, -1.0, 1.0);
+
+        Intr->N = side * v + f * sqrt(1 - v * v);
+      }
+      else
+        Intr->N = f;
+      Intr->Shp = this;
+      Intr->I[0] = h.Curve;
+      return true;
+    } /* End of 'Intersect' function */
+
+    /* Get normal at intersection virtual function.
+     * ARGUMENTS:
+     *   - intersection:
+     *       intr *Intr;
+     * RETURNS: None.
+     */
+    void GetNormal( intr *Intr ) override
+    {
+      /* Normal depends on the ray, it is evaluated in 'Intersect' */
+    } /* End of 'GetNormal' function */
+
+    /* Get shape bound box function.
+     * ARGUMENTS:
+     *   - box corners to fill:
+     *       vec3 &Min, &Max;
+     * RETURNS:
+     *   (bool) true if shape is bounded, false for infinite shapes.
+     */
+    bool GetBound( vec3 &Min, vec3 &Max ) override
+    {
+      if (!IsBuilt)
+        Build();
+      return Bvh.Bound().Get(Min, Max);
+    } /* End of 'GetBound' function */
+  }; /* End of 'curves' class */
+} /* end of 'tp5' namespace */
+
+#endif /* __curves_h_ */
+
+/* END OF 'curves.h' FILE */
@@ -0,0 +1,444 @@
+/* PROJECT     : tp5-rt
+ * FILE NAME   : displaced.h
+ * PROGRAMMER  : Tim Peterson
+ * LAST UPDATE : 19.10.2026
+ * PURPOSE     : Displacement mapped mesh shape defenition file.
+ * LICENSE     : MIT License
+ */
+
+#ifndef __displaced_h_
+#define __displaced_h_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <tuple>
+
+#include "rt/rt_bvh.h"
+#include "shape.h"
+#include "triangle.h"
+
+/* Base project namespace */
+namespace tp5
+{
+  /* Displacement mapped triangle mesh representation class.
+   * Base triangles are welded, vertices get smooth normals and every point
+   * of the surface is moved along interpolated normal by Height * Disp(P, N),
+   * where Disp gives values in [0, 1]. Only base mesh is stored: its BVH uses
+   * triangle boxes inflated by Height, micro triangles (Rate x Rate grid per
+   * base triangle) are made when a ray enters the box and are kept in a
+   * small per thread cache. Equal rate on all triangles keeps edges crack free.
+   */
+  class displaced : public shape
+  {
+  public:
+    /* Displacement function type, result is in [0, 1] */
+    typedef std::function<double (const vec3 &P, const vec3 &N)> disp;
+
+  private:
+    /* Micro geometry of one base triangle */
+    struct micro
+    {
+      stock<fvec3> P, N;     // Vertices and normals
+      stock<uint16_t> Tris;  // Triangles vertices
+      bvh Bvh;               // Hierarchy over triangles
+    }; /* End of 'micro' structure */
+
+    /* Per thread cache slot */
+    struct slot
+    {
+      unsigned Owner = 0;           // Shape id, 0 for empty slot
+      int Tri = -1;                 // Base triangle number
+      unsigned Stamp = 0;           // Last use time
+      std::unique_ptr<micro> Micro; // Geometry
+    }; /* End of 'slot' structure */
+
+    static const int CacheSize = 32; // Cache slots per thread
+
+    stock<vec3> V, VN;   // Base vertices and normals
+    stock<int> Idx;      // Base triangles vertices
+    stock<int>
+      VFirst,            // First 'VTris' entry of every base vertex (and end)
+      VTris;             // Base triangles around vertices
+    disp Disp;           // Displacement function
+    double Height;       // Max displacement
+    int Rate;            // Micro grid resolution
+    bvh Bvh;             // Hierarchy over inflated triangle boxes
+    unsigned Id;         // Unique shape id for caches
+
+    /* Displaced point of micro grid function.
+     * ARGUMENTS:
+     *   - base triangle number:
+     *       int T;
+     *   - grid vertex (barycentrics are (I, J) / Rate):
+     *       int I, J;
+     * RETURNS:
+     *   (vec3) point.
+     */
+    vec3 Displace( int T, int I, int J ) const
+    {
+      const vec3
+        &p0 = V[Idx[T * 3]], &p1 = V[Idx[T * 3 + 1]], &p2 = V[Idx[T * 3 + 2]],
+        &n0 = VN[Idx[T * 3]], &n1 = VN[Idx[T * 3 + 1]], &n2 = VN[Idx[T * 3 + 2]];
+      double u = (double)I / Rate, v = (double)J / Rate, w = 1 - u - v;
+      vec3
+        p = p0 * w + p1 * u + p2 * v,
+        n = (n0 * w + n1 * u + n2 * v).Normalizing();
+
+      return p + n * (Height * Disp(p, n));
+    } /* End of 'Displace' function */
+
+    /* Build micro geometry function.
+     * ARGUMENTS:
+     *   - base triangle number:
+     *       int T;
+     *   - geometry to fill:
+     *       micro &M;
+     * RETURNS: None.
+     */
+    void Tessellate( int T, micro &M ) const
+    {
+      stock<vec3> nrm;
+      auto at = [&]( int I, int J ){ return J * (2 * Rate + 3 - J) / 2 + I; };
+
+      /* Row J holds Rate - J + 1 vertices at barycentrics (I, J) / Rate */
+      M.P.clear(), M.N.clear(), M.Tris.clear();
+      for (int j = 0; j <= Rate; j++)
+        for (int i = 0; i <= Rate - j; i++)
+        {
+          vec3 d = Displace(T, i, j);
+
+          M.P << fvec3((float)d.X, (float)d.Y, (float)d.Z);
+        }
+      for (int j = 0; j < Rate; j++)
+        for (int i = 0; i < Rate - j; i++)
+        {
+          M.Tris << at(i, j) << at(i + 1, j) << at(i, j + 1);
+          if (i + j + 1 < Rate)
+            M.Tris << at(i + 1, j) << at(i + 1, j + 1) << at(i, j + 1);
+        }
+
+      /* Vertex normals from micro faces around */
+      nrm.resize(M.P.size(), vec3(0));
+      for (size_t i = 0; i < M.Tris.size(); i += 3)
+      {
+        auto d = [&]( int K ){ const fvec3 &p = M.P[M.Tris[i + K]]; return vec3(p.X, p.Y, p.Z); };
+        vec3 n = (d(1) - d(0)) % (d(2) - d(0));
+
+        for (int k = 0; k < 3; k++)
+          nrm[M.Tris[i + k]] += n;
+      }
+
+      /* Vertices on base edges also take faces of base triangles sharing
+       * them, so both sides get the same normal. Only faces touching
+       * these vertices are built, neighbours are never tessellated whole. */
+      std::map<std::tuple<int, int, int>, vec3> pts;
+      auto pt = [&]( int N, int I, int J ) -> const vec3 &
+      {
+        auto it = pts.find({N, I, J});
+
+        if (it == pts.end())
+          it = pts.emplace(std::make_tuple(N, I, J), Displace(N, I, J)).first;
+        return it->second;
+      };
+      auto base = [&]( int N ){ return (V[Idx[N * 3 + 1]] - V[Idx[N * 3]]) % (V[Idx[N * 3 + 2]] - V[Idx[N * 3]]); };
+      vec3 own = base(T);
+
+      for (int j = 0; j <= Rate; j++)
+        for (int i = 0; i <= Rate - j; i++)
+        {
+          int w[3] = {Rate - i - j, i, j};
+
+          if (w[0] != 0 && w[1] != 0 && w[2] != 0)
+            continue;
+
+          /* Base triangles holding all base vertices with nonzero weight */
+          int v0 = Idx[T * 3 + (w[0] != 0 ? 0 : w[1] != 0 ? 1 : 2)];
+
+          for (int f = VFirst[v0]; f < VFirst[v0 + 1]; f++)
+          {
+            int N = VTris[f], c[3] = {0, 0, 0}, found = 0;
+
+            if (N == T)
+              continue;
+            for (int k = 0; k < 3; k++)
+              for (int m = 0; m < 3; m++)
+                if (w[k] != 0 && Idx[N * 3 + m] == Idx[T * 3 + k])
+                  c[m] = w[k], found++;
+            if (found != (w[0] != 0) + (w[1] != 0) + (w[2] != 0))
+              continue;
+
+            /* Faces of neighbour grid around its vertex (I, J) */
+            int I = c[1], J = c[2];
+            double sign = (base(N) & own) < 0 ? -1 : 1;
+            const int faces[6][6] =
+            {
+              {I, J, I + 1, J, I, J + 1}, {I - 1, J, I, J, I - 1, J + 1}, {I, J - 1, I + 1, J - 1, I, J},
+              {I, J, I, J + 1, I - 1, J + 1}, {I + 1, J - 1, I + 1, J, I, J}, {I, J - 1, I, J, I - 1, J}
+            };
+
+            for (auto &fc : faces)
+            {
+              bool ok = true;
+
+              for (int k = 0; k < 6; k += 2)
+                ok = ok && fc[k] >= 0 && fc[k + 1] >= 0 && fc[k] + fc[k + 1] <= Rate;
+              if (ok)
+              {
+                const vec3 &a = pt(N, fc[0], fc[1]), &b = pt(N, fc[2], fc[3]), &d = pt(N, fc[4], fc[5]);
+
+                nrm[at(i, j)] += ((b - a) % (d - a)) * sign;
+              }
+            }
+          }
+        }
+      for (auto &n : nrm)
+      {
+        vec3 nn = (n & n) > 0 ? n.Normalizing() : vec3(0, 1, 0);
+
+        M.N << fvec3((float)nn.X, (float)nn.Y, (float)nn.Z);
+      }
+
+      M.Bvh.Build((int)M.Tris.size() / 3,
+        [&]( int I )
+        {
+          aabb b;
+
+          return b << M.P[M.Tris[I * 3]] << M.P[M.Tris[I * 3 + 1]] << M.P[M.Tris[I * 3 + 2]];
+        });
+      stock<uint16_t> tris;
+
+      tris.resize(M.Tris.size());
+      for (size_t i = 0; i < M.Bvh.Index.size(); i++)
+        for (int k = 0; k < 3; k++)
+          tris[i * 3 + k] = M.Tris[M.Bvh.Index[i] * 3 + k];
+      M.Tris.swap(tris);
+    } /* End of 'Tessellate' function */
+
+    /* Get micro geometry from this thread cache function.
+     * ARGUMENTS:
+     *   - base triangle number:
+     *       int T;
+     * RETURNS:
+     *   (const micro &) geometry, valid until the next call on this thread.
+     */
+    const micro & Get( int T ) const
+    {
+      thread_local slot slots[CacheSize];
+      thread_local unsigned clock = 0;
+      slot *old = &slots[0];
+
+      clock++;
+      for (auto &s : slots)
+      {
+        if (s.Owner == Id && s.Tri == T)
+        {
+          s.Stamp = clock;
+          return *s.Micro;
+        }
+        if (s.Stamp < old->Stamp)
+          old = &s;
+      }
+
+      /* Least recently used slot is reused, its memory too */
+      if (!old->Micro)
+        old->Micro = std::make_unique<micro>();
+      old->Owner = Id, old->Tri = T, old->Stamp = clock;
+      Tessellate(T, *old->Micro);
+      return *old->Micro;
+    } /* End of 'Get' function */
+
+    /* Set base mesh from triangles function.
+     * ARGUMENTS:
+     *   - triangles:
+     *       const stock<triangle *> &Tris;
+     * RETURNS: None.
+     */
+    void Setup( const stock<triangle *> &Tris )
+    {
+      std::map<std::tuple<double, double, double>, int> weld;
+
+      /* Welding makes shared normals, so neighbours displace edges equally */
+      for (auto *t : Tris)
+        for (const vec3 *p : {&t->P0, &t->P1, &t->P2})
+        {
+          auto it = weld.emplace(std::make_tuple(p->X, p->Y, p->Z), (int)V.size());
+
+          if (it.second)
+            V << *p;
+          Idx << it.first->second;
+        }
+      VN.resize(V.size(), vec3(0));
+      for (size_t i = 0; i < Idx.size(); i += 3)
+      {
+        vec3 n = (V[Idx[i + 1]] - V[Idx[i]]) % (V[Idx[i + 2]] - V[Idx[i]]);
+
+        for (int k = 0; k < 3; k++)
+          VN[Idx[i + k]] += n;
+      }
+      for (auto &n : VN)
+        n = (n & n) > 0 ? n.Normalizing() : vec3(0, 1, 0);
+
+      /* Triangles around every vertex */
+      VFirst.assign(V.size() + 1, 0);
+      for (int v : Idx)
+        VFirst[v + 1]++;
+      for (size_t i = 0; i < V.size(); i++)
+        VFirst[i + 1] += VFirst[i];
+      VTris.resize(Idx.size());
+      {
+        stock<int> fill;
+
+        fill.assign(VFirst.begin(), VFirst.end() - 1);
+        for (size_t i = 0; i < Idx.size(); i++)
+          VTris[fill[Idx[i]]++] = (int)(i / 3);
+      }
+
+      /* Interpolated normal m = sum(w * n) has |m| >= min(n & c), c is mean
+       * normal, so offset along normalized m is bounded by normals range
+       * divided by that. Displacement is not known without tessellation. */
+      Bvh.Build((int)Idx.size() / 3,
+        [&]( int I )
+        {
+          const vec3 *n[3] = {&VN[Idx[I * 3]], &VN[Idx[I * 3 + 1]], &VN[Idx[I * 3 + 2]]};
+          vec3 c = *n[0] + *n[1] + *n[2];
+          double cmin = (c & c) > 0 ? std::min({*n[0] & c, *n[1] & c, *n[2] & c}) / sqrt(c & c) : 0;
+          fvec3 lo, hi;
+          aabb b;
+
+          for (int a = 0; a < 3; a++)
+          {
+            double
+              l = std::min({(*n[0])[a], (*n[1])[a], (*n[2])[a]}),
+              h = std::max({(*n[0])[a], (*n[1])[a], (*n[2])[a]});
+
+            if (cmin > 0.01)
+              l = std::max(-1.0, std::min(l, l / cmin)), h = std::min(1.0, std::max(h, h / cmin));
+            else
+              l = -1, h = 1;
+            lo[a] = (float)(Height * std::min(0.0, l));
+            hi[a] = (float)(Height * std::max(0.0, h));
+          }
+          for (int k = 0; k < 3; k++)
+          {
+            const vec3 &p = V[Idx[I * 3 + k]];
+            fvec3
+              fp((float)p.X, (float)p.Y, (float)p.Z),
+              e((float)(1e-6 * (std::max({std::abs(p.X), std::abs(p.Y), std::abs(p.Z)}) + Height)));
+
+            /* Padding covers float rounding of micro vertices */
+            b << fp + lo - e << fp + hi + e;
+          }
+          return b;
+        }, 1);
+    } /* End of 'Setup' function */
+
+  public:
+    /* 'displaced' class constructor function.
+     * ARGUMENTS:
+     *   - base mesh (obj or g3dm):
+     *       const mesh_type &Mesh;
+     *   - displacement function:
+     *       const disp &D;
+     *   - max displacement:
+     *       double H;
+     *   - micro grid resolution (1 to 128):
+     *       int MicroRate;
+     *   - material:
+     *       const material &M;
+     */
+    template<class mesh_type>
+      displaced( const mesh_type &Mesh, const disp &D, double H, int MicroRate = 32,
+                 const material &M = material() ) :
+        shape(M), Disp(D), Height(H), Rate(std::clamp(MicroRate, 1, 128))
+      {
+        static std::atomic<unsigned> NextId(1);
+
+        Id = NextId++;
+        Setup(Mesh.GetTris());
+      } /* End of 'displaced' function */
+
+    /* Shape intersect virtual function.
+     * ARGUMENTS:
+     *   - ray to intersect with:
+     *       const ray &R;
+     *   - intersection structure:
+     *       intr *Intr;
+     * RETURNS:
+     *   (bool) true if intersected, false otherwise.
+     */
+    bool Intersect( const ray &R, intr *Intr ) override
+    {
+      double tmax = std::numeric_limits<double>::max();
+      int bb = -1, bt = -1;
+
+      Bvh.Traverse(R, tmax,
+        [&]( int First, int Count, double &TMax ) -> bool
+        {
+          bool hit = false;
+
+          for (int f = First; f < First + Count; f++)
+          {
+            int b = Bvh.Index[f];
+            const micro &m = Get(b);
+
+            hit |= m.Bvh.Traverse(R, TMax,
+              [&]( int MFirst, int MCount, double &TMax ) -> bool
+              {
+                bool h = false;
+
+                for (int i = MFirst; i < MFirst + MCount; i++)
+                {
+                  const uint16_t *tr = &m.Tris[i * 3];
+                  double u, v, t = TriIntersect(m.P[tr[0]], m.P[tr[1]], m.P[tr[2]], R, u, v);
+
+                  if (t > Trashold && t < TMax)
+                    TMax = t, bb = b, bt = i, h = true;
+                }
+                return h;
+              });
+          }
+          return hit;
+        });
+      if (bb == -1)
+        return false;
+      Intr->T = tmax;
+      Intr->Shp = this;
+      Intr->I[0] = bb;
+      Intr->I[1] = bt;
+      return true;
+    } /* End of 'Intersect' function */
+
+    /* Get normal at intersection virtual function.
+     * ARGUMENTS:
+     *   - intersection:
+     *       intr *Intr;
+     * RETURNS: None.
+     */
+    void GetNormal( intr *Intr ) override
+    {
+      const micro &m = Get(Intr->I[0]);
+      const uint16_t *t = &m.Tris[Intr->I[1] * 3];
+
+      Intr->N = TriNormal(m.P[t[0]], m.P[t[1]], m.P[t[2]], m.N[t[0]], m.N[t[1]], m.N[t[2]], Intr->P);
+    } /* End of 'GetNormal' function */
+
+    /* Get shape bound box function.
+     * ARGUMENTS:
+     *   - box corners to fill:
+     *       vec3 &Min, &Max;
+     * RETURNS:
+     *   (bool) true if shape is bounded, false for infinite shapes.
+     */
+    bool GetBound( vec3 &Min, vec3 &Max ) override
+    {
+      return Bvh.Bound().Get(Min, Max);
+    } /* End of 'GetBound' function */
+  }; /* End of 'displaced' class */
+} /* end of 'tp5' namespace */
+
+#endif /* __displaced_h_ */
+
+/* END OF 'displaced.h' FILE */
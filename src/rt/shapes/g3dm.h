@@ -108,7 +108,7 @@ namespace tp5
         ptr += sizeof(dword) * NumOfFacetIndexes;
 
         for (int i = 0; i < NumOfFacetIndexes; i += 3)
-          Tris << new triangle(V[i].P, V[i + 1].P, V[i + 2].P);
+          Tris << new triangle(V[I[i]].P, V[I[i + 1]].P, V[I[i + 2]].P);
       }
 
       free(mem);
@@ -153,6 +153,21 @@ namespace tp5
     {
     } /* End of 'GetNormal' function */
 
+    /* Get shape bound box function.
+     * ARGUMENTS:
+     *   - box corners to fill:
+     *       vec3 &Min, &Max;
+     * RETURNS:
+     *   (bool) true if shape is bounded, false for infinite shapes.
+     */
+    bool GetBound( vec3 &Min, vec3 &Max ) override
+    {
+      if (Tris.empty())
+        return false;
+      GetBoundBox(Min, Max);
+      return true;
+    } /* End of 'GetBound' function */
+
     /* Check if point is inside shape function.
      * ARGUMENTS:
      *   - point to check:
@@ -251,6 +266,16 @@ namespace tp5
           B0.Z = tri->P2.Z;
       }
     } /* End of 'GetBoundBox' function */
+
+    /* Get mesh triangles function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (const stock<triangle *> &) triangles.
+     */
+    const stock<triangle *> & GetTris( void ) const
+    {
+      return Tris;
+    } /* End of 'GetTris' function */
   }; /* End of 'g3dm' class */
 } /* end of 'tp5' namespace */
 
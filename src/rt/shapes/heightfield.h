@@ -0,0 +1,489 @@
+/* PROJECT     : tp5-rt
+ * FILE NAME   : heightfield.h
+ * PROGRAMMER  : Tim Peterson
+ * LAST UPDATE : 19.10.2026
+ * PURPOSE     : Heightfield terrain shape defenition file.
+ * LICENSE     : MIT License
+ */
+
+#ifndef __heightfield_h_
+#define __heightfield_h_
+
+#include <cstdint>
+#include <limits>
+
+#include "lib/stb_image.h"
+#include "shape.h"
+
+/* Base project namespace */
+namespace tp5
+{
+  /* Heightfield terrain shape representation class.
+   * Heights are stored quantized to 16 bits. Traversal walks a min/max
+   * pyramid over grid cells with a 2D DDA, skipping whole blocks of cells
+   * the ray passes above (or below) and testing two triangles per leaf cell.
+   */
+  class heightfield : public shape
+  {
+  private:
+    int W, H;                      // Grid size in samples
+    int Top;                       // Top pyramid level
+    vec3 Pos, Size;                // Grid corner and (X, height scale, Z) extent
+    double Dx, Dz;                 // Cell size in world units
+    double YBase, YScale;          // Quantized height to world Y conversion
+    stock<uint16_t> Heights;       // Quantized samples
+    stock<stock<uint16_t>> Pyr;    // Min/max pairs of levels 2..Top
+    stock<int> LevelW, LevelH;     // Nodes per level
+
+    /* Get quantized sample function.
+     * ARGUMENTS:
+     *   - sample coordinates:
+     *       int X, Z;
+     * RETURNS:
+     *   (uint16_t) quantized height.
+     */
+    uint16_t Sample( int X, int Z ) const
+    {
+      return Heights[(size_t)Z * W + X];
+    } /* End of 'Sample' function */
+
+    /* Get world height of a sample function.
+     * ARGUMENTS:
+     *   - sample coordinates:
+     *       int X, Z;
+     * RETURNS:
+     *   (double) world Y.
+     */
+    double Height( int X, int Z ) const
+    {
+      return YBase + Sample(X, Z) * YScale;
+    } /* End of 'Height' function */
+
+    /* Get min/max of samples in rectangle function.
+     * ARGUMENTS:
+     *   - inclusive sample rectangle (clamped to grid):
+     *       int X0, Z0, X1, Z1;
+     *   - result range:
+     *       uint16_t &Mn, &Mx;
+     * RETURNS: None.
+     */
+    void SampleRange( int X0, int Z0, int X1, int Z1, uint16_t &Mn, uint16_t &Mx ) const
+    {
+      X1 = X1 < W - 1 ? X1 : W - 1;
+      Z1 = Z1 < H - 1 ? Z1 : H - 1;
+      Mn = 0xFFFF, Mx = 0;
+      for (int z = Z0; z <= Z1; z++)
+        for (int x = X0; x <= X1; x++)
+        {
+          uint16_t h = Sample(x, z);
+
+          Mn = h < Mn ? h : Mn;
+          Mx = h > Mx ? h : Mx;
+        }
+    } /* End of 'SampleRange' function */
+
+    /* Get world height range of pyramid node function.
+     * ARGUMENTS:
+     *   - level and node coordinates:
+     *       int L, A, B;
+     *   - result range:
+     *       double &Mn, &Mx;
+     * RETURNS: None.
+     */
+    void NodeRange( int L, int A, int B, double &Mn, double &Mx ) const
+    {
+      uint16_t mn, mx;
+
+      /* Two lowest levels are taken from samples directly to save memory */
+      if (L < 2)
+        SampleRange(A << L, B << L, (A + 1) << L, (B + 1) << L, mn, mx);
+      else
+      {
+        const uint16_t *n = &Pyr[L - 2][((size_t)B * LevelW[L] + A) * 2];
+
+        mn = n[0], mx = n[1];
+      }
+      Mn = YBase + mn * YScale;
+      Mx = YBase + mx * YScale;
+      if (Mn > Mx)
+        std::swap(Mn, Mx);
+    } /* End of 'NodeRange' function */
+
+    /* Get node index containing coordinate function.
+     * ARGUMENTS:
+     *   - grid coordinate and ray direction along it:
+     *       double X, D;
+     *   - node size in cells:
+     *       int S;
+     * RETURNS:
+     *   (int) node index.
+     */
+    static int Node( double X, double D, int S )
+    {
+      double q = X / S;
+      int n = (int)std::floor(q);
+
+      /* Exactly on a node border: pick the node the ray goes into */
+      if (D < 0 && q - n < 1e-9)
+        n--;
+      else if (D > 0 && q - n > 1 - 1e-9)
+        n++;
+      return n;
+    } /* End of 'Node' function */
+
+    /* Build min/max pyramid function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    void BuildPyramid( void )
+    {
+      int cw = W - 1, ch = H - 1;
+
+      LevelW.clear(), LevelH.clear(), Pyr.clear();
+      Top = 0;
+      LevelW << cw, LevelH << ch;
+      while (LevelW[Top] > 1 || LevelH[Top] > 1)
+      {
+        Top++;
+        LevelW << ((cw + (1 << Top) - 1) >> Top);
+        LevelH << ((ch + (1 << Top) - 1) >> Top);
+      }
+
+      for (int l = 2; l <= Top; l++)
+      {
+        stock<uint16_t> lev;
+
+        lev.resize((size_t)LevelW[l] * LevelH[l] * 2);
+        for (int b = 0; b < LevelH[l]; b++)
+          for (int a = 0; a < LevelW[l]; a++)
+          {
+            uint16_t mn = 0xFFFF, mx = 0;
+
+            if (l == 2)
+              SampleRange(a << 2, b << 2, (a + 1) << 2, (b + 1) << 2, mn, mx);
+            else
+            {
+              const stock<uint16_t> &sub = Pyr[l - 3];
+
+              for (int j = 2 * b; j <= 2 * b + 1 && j < LevelH[l - 1]; j++)
+                for (int i = 2 * a; i <= 2 * a + 1 && i < LevelW[l - 1]; i++)
+                {
+                  const uint16_t *n = &sub[((size_t)j * LevelW[l - 1] + i) * 2];
+
+                  mn = n[0] < mn ? n[0] : mn;
+                  mx = n[1] > mx ? n[1] : mx;
+                }
+            }
+            lev[((size_t)b * LevelW[l] + a) * 2] = mn;
+            lev[((size_t)b * LevelW[l] + a) * 2 + 1] = mx;
+          }
+        Pyr << std::move(lev);
+      }
+    } /* End of 'BuildPyramid' function */
+
+    /* Set up placement function.
+     * ARGUMENTS:
+     *   - real height range of quantized values:
+     *       double HMin, HMax;
+     * RETURNS: None.
+     */
+    void Setup( double HMin, double HMax )
+    {
+      Dx = W > 1 ? Size.X / (W - 1) : 1;
+      Dz = H > 1 ? Size.Z / (H - 1) : 1;
+      YBase  = Pos.Y + HMin * Size.Y;
+      YScale = (HMax - HMin) / 65535.0 * Size.Y;
+      if (W > 1 && H > 1)
+        BuildPyramid();
+    } /* End of 'Setup' function */
+
+    /* Ray/triangle intersection in grid space function.
+     * ARGUMENTS:
+     *   - grid space ray origin and direction:
+     *       const vec3 &O, &D;
+     *   - triangle vertexes:
+     *       const vec3 &A, &B, &C;
+     *   - result distance:
+     *       double &T;
+     * RETURNS:
+     *   (bool) true if intersected, false otherwise.
+     */
+    static bool TriIntersect( const vec3 &O, const vec3 &D, const vec3 &A, const vec3 &B, const vec3 &C, double &T )
+    {
+      vec3 e1 = B - A, e2 = C - A, p = D % e2;
+      double det = e1 & p;
+
+      if (std::abs(det) < 1e-12)
+        return false;
+
+      double inv = 1 / det;
+      vec3 s = O - A;
+      double u = (s & p) * inv;
+
+      if (u < 0 || u > 1)
+        return false;
+
+      vec3 q = s % e1;
+      double v = (D & q) * inv;
+
+      if (v < 0 || u + v > 1)
+        return false;
+      T = (e2 & q) * inv;
+      return true;
+    } /* End of 'TriIntersect' function */
+
+    /* Get cell triangle vertexes in grid space function.
+     * ARGUMENTS:
+     *   - cell and triangle number:
+     *       int A, B, Tri;
+     *   - result vertexes:
+     *       vec3 &P0, &P1, &P2;
+     * RETURNS: None.
+     */
+    void CellTri( int A, int B, int Tri, vec3 &P0, vec3 &P1, vec3 &P2 ) const
+    {
+      P0 = vec3(A, Height(A, B), B);
+      P1 = Tri == 0 ? vec3(A + 1, Height(A + 1, B), B) : vec3(A + 1, Height(A + 1, B + 1), B + 1);
+      P2 = Tri == 0 ? vec3(A + 1, Height(A + 1, B + 1), B + 1) : vec3(A, Height(A, B + 1), B + 1);
+    } /* End of 'CellTri' function */
+
+  public:
+    /* 'heightfield' class constructor by float grid function.
+     * ARGUMENTS:
+     *   - row-major heights (W * H values):
+     *       const float *Grid;
+     *   - grid size in samples:
+     *       int GridW, GridH;
+     *   - grid corner position:
+     *       const vec3 &P;
+     *   - grid extent (X, height scale, Z):
+     *       const vec3 &S;
+     *   - material:
+     *       const material &M;
+     */
+    heightfield( const float *Grid, int GridW, int GridH, const vec3 &P, const vec3 &S, const material &M = material() ) :
+      shape(M), W(GridW), H(GridH), Top(0), Pos(P), Size(S)
+    {
+      double hmin = Grid[0], hmax = Grid[0];
+      size_t n = (size_t)W * H;
+
+      for (size_t i = 1; i < n; i++)
+        hmin = min(hmin, Grid[i]), hmax = max(hmax, Grid[i]);
+      if (hmax == hmin)
+        hmax = hmin + 1;
+
+      Heights.resize(n);
+      for (size_t i = 0; i < n; i++)
+        Heights[i] = (uint16_t)std::lround((Grid[i] - hmin) / (hmax - hmin) * 65535);
+      Setup(hmin, hmax);
+    } /* End of 'heightfield' function */
+
+    /* 'heightfield' class constructor by grayscale image function.
+     * ARGUMENTS:
+     *   - image file name (8 or 16 bit, brightness 0..1 maps to 0..S.Y):
+     *       const char *FileName;
+     *   - grid corner position:
+     *       const vec3 &P;
+     *   - grid extent (X, height scale, Z):
+     *       const vec3 &S;
+     *   - material:
+     *       const material &M;
+     */
+    heightfield( const char *FileName, const vec3 &P, const vec3 &S, const material &M = material() ) :
+      shape(M), W(0), H(0), Top(0), Pos(P), Size(S)
+    {
+      int c;
+      stbi_us *img = stbi_load_16(FileName, &W, &H, &c, 1);
+
+      if (img == nullptr)
+      {
+        W = H = 0;
+        return;
+      }
+      Heights.assign(img, img + (size_t)W * H);
+      stbi_image_free(img);
+      Setup(0, 1);
+    } /* End of 'heightfield' function */
+
+    /* Shape intersect virtual function.
+     * ARGUMENTS:
+     *   - ray to intersect with:
+     *       const ray &R;
+     *   - intersection structure:
+     *       intr *Intr;
+     * RETURNS:
+     *   (bool) true if intersected, false otherwise.
+     */
+    bool Intersect( const ray &R, intr *Intr ) override
+    {
+      const double inf = std::numeric_limits<double>::infinity();
+
+      if (W < 2 || H < 2)
+        return false;
+
+      /* Grid space ray: X and Z in cells, Y in world units, same T */
+      vec3
+        o((R.Org.X - Pos.X) / Dx, R.Org.Y, (R.Org.Z - Pos.Z) / Dz),
+        d(R.Dir.X / Dx, R.Dir.Y, R.Dir.Z / Dz);
+      double ymin, ymax, t0 = Trashold, t1 = inf;
+
+      /* Clip by bound box */
+      NodeRange(Top, 0, 0, ymin, ymax);
+      vec3 b0(0, ymin, 0), b1(W - 1, ymax, H - 1);
+      for (int i = 0; i < 3; i++)
+      {
+        if (d[i] == 0)
+        {
+          if (o[i] < b0[i] || o[i] > b1[i])
+            return false;
+          continue;
+        }
+        double
+          ta = (b0[i] - o[i]) / d[i],
+          tb = (b1[i] - o[i]) / d[i];
+        if (ta > tb)
+          std::swap(ta, tb);
+        t0 = max(t0, ta);
+        t1 = min(t1, tb);
+      }
+      if (t0 > t1)
+        return false;
+
+      int L = Top;
+      double t = t0;
+
+      while (t <= t1)
+      {
+        int s = 1 << L;
+        vec3 p = o + d * t;
+        int a = Node(p.X, d.X, s), b = Node(p.Z, d.Z, s);
+
+        if (a < 0 || b < 0 || a >= LevelW[L] || b >= LevelH[L])
+          break;
+
+        /* Node exit distance */
+        double
+          tx = d.X > 0 ? ((a + 1) * s - o.X) / d.X : d.X < 0 ? (a * s - o.X) / d.X : inf,
+          tz = d.Z > 0 ? ((b + 1) * s - o.Z) / d.Z : d.Z < 0 ? (b * s - o.Z) / d.Z : inf,
+          te = min(min(tx, tz), t1);
+        double
+          y0 = o.Y + d.Y * t,
+          y1 = o.Y + d.Y * te,
+          mn, mx;
+
+        NodeRange(L, a, b, mn, mx);
+        if (min(y0, y1) <= mx && max(y0, y1) >= mn)
+        {
+          if (L > 0)
+          {
+            L--;
+            continue;
+          }
+
+          /* Leaf cell: test both triangles */
+          double tbest = inf;
+          int tri = -1;
+
+          for (int k = 0; k < 2; k++)
+          {
+            vec3 p0, p1, p2;
+            double th;
+
+            CellTri(a, b, k, p0, p1, p2);
+            if (TriIntersect(o, d, p0, p1, p2, th) && th > Trashold && th >= t - 1e-9 && th <= te + 1e-9 && th < tbest)
+              tbest = th, tri = k;
+          }
+          if (tri != -1)
+          {
+            Intr->T = tbest;
+            Intr->Shp = this;
+            Intr->I[0] = a;
+            Intr->I[1] = b;
+            Intr->I[2] = tri;
+            return true;
+          }
+        }
+
+        /* Step to neighbour node, climb up if it belongs to other parent */
+        if (L < Top)
+        {
+          int na = a, nb = b;
+
+          if (tx <= tz)
+            na += d.X > 0 ? 1 : -1;
+          else
+            nb += d.Z > 0 ? 1 : -1;
+          if ((na >> 1) != (a >> 1) || (nb >> 1) != (b >> 1))
+            L++;
+        }
+        t = te > t ? te : t + 1e-9;
+      }
+      return false;
+    } /* End of 'Intersect' function */
+
+    /* Get normal at intersection virtual function.
+     * ARGUMENTS:
+     *   - intersection:
+     *       intr *Intr;
+     * RETURNS: None.
+     */
+    void GetNormal( intr *Intr ) override
+    {
+      vec3 p0, p1, p2;
+
+      CellTri(Intr->I[0], Intr->I[1], Intr->I[2], p0, p1, p2);
+
+      vec3
+        e1 = (p1 - p0) * vec3(Dx, 1, Dz),
+        e2 = (p2 - p0) * vec3(Dx, 1, Dz),
+        n = (e1 % e2).Normalizing();
+
+      Intr->N = n.Y < 0 ? -n : n;
+    } /* End of 'GetNormal' function */
+
+    /* Get shape bound box function.
+     * ARGUMENTS:
+     *   - box corners to fill:
+     *       vec3 &Min, &Max;
+     * RETURNS:
+     *   (bool) true if shape is bounded, false for infinite shapes.
+     */
+    bool GetBound( vec3 &Min, vec3 &Max ) override
+    {
+      double y1 = YBase + YScale * 65535;
+
+      Min = vec3(std::min(Pos.X, Pos.X + Size.X), std::min(YBase, y1), std::min(Pos.Z, Pos.Z + Size.Z));
+      Max = vec3(std::max(Pos.X, Pos.X + Size.X), std::max(YBase, y1), std::max(Pos.Z, Pos.Z + Size.Z));
+      return true;
+    } /* End of 'GetBound' function */
+
+    /* Check if point is inside shape function.
+     * ARGUMENTS:
+     *   - point to check:
+     *       const vec3 &P;
+     * RETURNS:
+     *   (bool) true if is inside (under the surface), false, otherwise
+     */
+    bool IsInside( const vec3 &P ) override
+    {
+      double u = (P.X - Pos.X) / Dx, v = (P.Z - Pos.Z) / Dz;
+
+      if (W < 2 || H < 2 || u < 0 || v < 0 || u > W - 1 || v > H - 1)
+        return false;
+
+      int a = std::min((int)u, W - 2), b = std::min((int)v, H - 2);
+      double fu = u - a, fv = v - b, h;
+
+      /* Interpolate over the cell triangle containing the point */
+      if (fu >= fv)
+        h = Height(a, b) + (Height(a + 1, b) - Height(a, b)) * (fu - fv) + (Height(a + 1, b + 1) - Height(a, b)) * fv;
+      else
+        h = Height(a, b) + (Height(a + 1, b + 1) - Height(a, b)) * fu + (Height(a, b + 1) - Height(a, b)) * (fv - fu);
+      return P.Y < h;
+    } /* End of 'IsInside' function */
+  }; /* End of 'heightfield' class */
+} /* end of 'tp5' namespace */
+
+#endif /* __heightfield_h_ */
+
+/* END OF 'heightfield.h' FILE */
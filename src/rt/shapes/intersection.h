@@ -87,6 +87,42 @@ namespace tp5
       void GetNormal( intr *Intr ) override
       {
       } /* End of 'GetNormal' function */
+
+      /* Get shape bound box function.
+       * ARGUMENTS:
+       *   - box corners to fill:
+       *       vec3 &Min, &Max;
+       * RETURNS:
+       *   (bool) true if shape is bounded, false for infinite shapes.
+       */
+      bool GetBound( vec3 &Min, vec3 &Max ) override
+      {
+        vec3 a0, a1, b0, b1;
+        bool
+          ha = ShpA->GetBound(a0, a1),
+          hb = ShpB->GetBound(b0, b1);
+
+        if (ha && hb)
+        {
+          Min = vec3(std::max(a0.X, b0.X), std::max(a0.Y, b0.Y), std::max(a0.Z, b0.Z));
+          Max = vec3(std::min(a1.X, b1.X), std::min(a1.Y, b1.Y), std::min(a1.Z, b1.Z));
+        }
+        else if (ha || hb)
+          Min = ha ? a0 : b0, Max = ha ? a1 : b1;
+        return ha || hb;
+      } /* End of 'GetBound' function */
+
+      /* Prepare shape for rendering from camera function.
+       * ARGUMENTS:
+       *   - camera:
+       *       const camera &Cam;
+       * RETURNS: None.
+       */
+      void SetView( const camera &Cam ) override
+      {
+        ShpA->SetView(Cam);
+        ShpB->SetView(Cam);
+      } /* End of 'SetView' function */
     }; /* End of 'intersection' class */
   } /* end of 'csg' namespace */
 } /* end of 'tp5' namespace */
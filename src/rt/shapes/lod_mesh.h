@@ -0,0 +1,528 @@
+/* PROJECT     : tp5-rt
+ * FILE NAME   : lod_mesh.h
+ * PROGRAMMER  : Tim Peterson
+ * LAST UPDATE : 19.10.2026
+ * PURPOSE     : Level of detail triangle mesh shape defenition file.
+ * LICENSE     : MIT License
+ */
+
+#ifndef __lod_mesh_h_
+#define __lod_mesh_h_
+
+#include <algorithm>
+#include <map>
+#include <queue>
+#include <tuple>
+
+#include "rt/rt_bvh.h"
+#include "shape.h"
+#include "triangle.h"
+
+/* Base project namespace */
+namespace tp5
+{
+  /* Triangle mesh with simplification chain representation class.
+   * At load time mesh is welded and decimated by quadric error edge
+   * collapses, every level has about half faces of previous one and its own
+   * BVH. Each level keeps bound of its geometric error, ray takes the
+   * coarsest level which error is below pixel footprint at the distance
+   * where ray enters mesh box (camera pixel angle is given by 'SetView').
+   */
+  class lod_mesh : public shape
+  {
+  private:
+    /* Symmetric 4x4 error quadric */
+    struct quadric
+    {
+      double A[10] {}; // a11 a12 a13 a14 a22 a23 a24 a33 a34 a44
+
+      /* Make plane quadric function.
+       * ARGUMENTS:
+       *   - plane normal (normalized) and offset:
+       *       const vec3 &N, double D;
+       * RETURNS:
+       *   (quadric) squared distance to plane.
+       */
+      static quadric Plane( const vec3 &N, double D )
+      {
+        quadric q;
+
+        q.A[0] = N.X * N.X, q.A[1] = N.X * N.Y, q.A[2] = N.X * N.Z, q.A[3] = N.X * D;
+        q.A[4] = N.Y * N.Y, q.A[5] = N.Y * N.Z, q.A[6] = N.Y * D;
+        q.A[7] = N.Z * N.Z, q.A[8] = N.Z * D;
+        q.A[9] = D * D;
+        return q;
+      } /* End of 'Plane' function */
+
+      /* Add quadric operator function.
+       * ARGUMENTS:
+       *   - quadric to add:
+       *       const quadric &Q;
+       * RETURNS:
+       *   (quadric &) self reference.
+       */
+      quadric & operator+=( const quadric &Q )
+      {
+        for (int i = 0; i < 10; i++)
+          A[i] += Q.A[i];
+        return *this;
+      } /* End of 'operator+=' function */
+
+      /* Evaluate error at point function.
+       * ARGUMENTS:
+       *   - point:
+       *       const vec3 &P;
+       * RETURNS:
+       *   (double) sum of squared distances to planes.
+       */
+      double operator()( const vec3 &P ) const
+      {
+        return
+          A[0] * P.X * P.X + A[4] * P.Y * P.Y + A[7] * P.Z * P.Z +
+          2 * (A[1] * P.X * P.Y + A[2] * P.X * P.Z + A[5] * P.Y * P.Z) +
+          2 * (A[3] * P.X + A[6] * P.Y + A[8] * P.Z) + A[9];
+      } /* End of 'operator()' function */
+
+      /* Find point of minimal error on edge or near it function.
+       * ARGUMENTS:
+       *   - edge ends:
+       *       const vec3 &P0, &P1;
+       * RETURNS:
+       *   (vec3) point.
+       */
+      vec3 Best( const vec3 &P0, const vec3 &P1 ) const
+      {
+        vec3
+          r0(A[0], A[1], A[2]), r1(A[1], A[4], A[5]), r2(A[2], A[5], A[7]),
+          b(-A[3], -A[6], -A[8]),
+          c12 = r1 % r2;
+        double det = r0 & c12, s = (P1 - P0) & (P1 - P0);
+
+        /* Solution far from edge comes from flat neighbourhood, it is not used */
+        if (std::abs(det) > 1e-12)
+        {
+          vec3 p = vec3(b & c12, r0 & (b % r2), r0 & (r1 % b)) / det;
+
+          if (((p - (P0 + P1) / 2) & (p - (P0 + P1) / 2)) < s)
+            return p;
+        }
+
+        vec3 m = (P0 + P1) / 2, best = m;
+
+        if ((*this)(P0) < (*this)(best))
+          best = P0;
+        if ((*this)(P1) < (*this)(best))
+          best = P1;
+        return best;
+      } /* End of 'Best' function */
+    }; /* End of 'quadric' structure */
+
+    /* Simplification level */
+    struct level
+    {
+      stock<fvec3> P, N; // Vertices and normals
+      stock<int> Tris;   // Triangles vertices
+      bvh Bvh;           // Hierarchy over triangles
+      double Err;        // Geometric error bound
+    }; /* End of 'level' structure */
+
+    stock<level> Levels; // Levels from finest to coarsest
+    double Tolerance;    // Allowed error in pixels
+    double PixelAngle;   // Camera angle per pixel, 0 for finest level only
+
+    /* Add level from alive faces function.
+     * ARGUMENTS:
+     *   - vertices and faces:
+     *       const stock<vec3> &V; const stock<int> &F;
+     *   - dead faces flags:
+     *       const stock<char> &Dead;
+     *   - error bound:
+     *       double Err;
+     * RETURNS: None.
+     */
+    void AddLevel( const stock<vec3> &V, const stock<int> &F, const stock<char> &Dead, double Err )
+    {
+      level &l = Levels.emplace_back();
+      stock<int> remap;
+      stock<vec3> nrm;
+
+      l.Err = Err;
+      remap.resize(V.size(), -1);
+      for (size_t f = 0; f < Dead.size(); f++)
+        if (!Dead[f])
+          for (int k = 0; k < 3; k++)
+          {
+            int v = F[f * 3 + k];
+
+            if (remap[v] == -1)
+            {
+              remap[v] = (int)l.P.size();
+              l.P << fvec3((float)V[v].X, (float)V[v].Y, (float)V[v].Z);
+            }
+            l.Tris << remap[v];
+          }
+
+      /* Smooth normals of this level */
+      nrm.resize(l.P.size(), vec3(0));
+      for (size_t i = 0; i < l.Tris.size(); i += 3)
+      {
+        auto d = [&]( int K ){ const fvec3 &p = l.P[l.Tris[i + K]]; return vec3(p.X, p.Y, p.Z); };
+        vec3 n = (d(1) - d(0)) % (d(2) - d(0));
+
+        for (int k = 0; k < 3; k++)
+          nrm[l.Tris[i + k]] += n;
+      }
+      for (auto &n : nrm)
+      {
+        vec3 nn = (n & n) > 0 ? n.Normalizing() : vec3(0, 1, 0);
+
+        l.N << fvec3((float)nn.X, (float)nn.Y, (float)nn.Z);
+      }
+
+      l.Bvh.Build((int)l.Tris.size() / 3,
+        [&]( int I )
+        {
+          aabb b;
+
+          return b << l.P[l.Tris[I * 3]] << l.P[l.Tris[I * 3 + 1]] << l.P[l.Tris[I * 3 + 2]];
+        });
+      stock<int> tris;
+
+      tris.resize(l.Tris.size());
+      for (size_t i = 0; i < l.Bvh.Index.size(); i++)
+        for (int k = 0; k < 3; k++)
+          tris[i * 3 + k] = l.Tris[l.Bvh.Index[i] * 3 + k];
+      l.Tris.swap(tris);
+      l.Bvh.Index = stock<int>();
+    } /* End of 'AddLevel' function */
+
+    /* Build simplification chain function.
+     * ARGUMENTS:
+     *   - triangles:
+     *       const stock<triangle *> &Tris;
+     *   - max number of levels:
+     *       int MaxLevels;
+     * RETURNS: None.
+     */
+    void Setup( const stock<triangle *> &Tris, int MaxLevels )
+    {
+      std::map<std::tuple<double, double, double>, int> weld;
+      stock<vec3> V;
+      stock<int> F;
+
+      for (auto *t : Tris)
+        for (const vec3 *p : {&t->P0, &t->P1, &t->P2})
+        {
+          auto it = weld.emplace(std::make_tuple(p->X, p->Y, p->Z), (int)V.size());
+
+          if (it.second)
+            V << *p;
+          F << it.first->second;
+        }
+
+      int nv = (int)V.size(), nf = (int)F.size() / 3, alive = nf;
+      stock<quadric> q;
+      stock<stock<int>> vf;
+      stock<char> fdead, vdead;
+      stock<int> ver;
+      stock<std::pair<int, int>> edges;
+
+      q.resize(nv), vf.resize(nv), fdead.resize(nf, 0), vdead.resize(nv, 0), ver.resize(nv, 0);
+      for (int f = 0; f < nf; f++)
+      {
+        const vec3 &p0 = V[F[f * 3]], &p1 = V[F[f * 3 + 1]], &p2 = V[F[f * 3 + 2]];
+        vec3 n = (p1 - p0) % (p2 - p0);
+
+        for (int k = 0; k < 3; k++)
+        {
+          int a = F[f * 3 + k], b = F[f * 3 + (k + 1) % 3];
+
+          vf[a] << f;
+          edges << std::make_pair(std::min(a, b), std::max(a, b));
+        }
+        if ((n & n) == 0)
+          continue;
+        n.Normalize();
+        quadric fq = quadric::Plane(n, -(n & p0));
+
+        for (int k = 0; k < 3; k++)
+          q[F[f * 3 + k]] += fq;
+      }
+
+      /* Planes across boundary edges keep holes and borders in place */
+      std::sort(edges.begin(), edges.end());
+      for (int f = 0; f < nf; f++)
+        for (int k = 0; k < 3; k++)
+        {
+          int a = F[f * 3 + k], b = F[f * 3 + (k + 1) % 3];
+          auto e = std::make_pair(std::min(a, b), std::max(a, b));
+          auto r = std::equal_range(edges.begin(), edges.end(), e);
+
+          if (r.second - r.first != 1)
+            continue;
+          vec3
+            n = (V[F[f * 3 + 1]] - V[F[f * 3]]) % (V[F[f * 3 + 2]] - V[F[f * 3]]),
+            m = (V[b] - V[a]) % n;
+
+          if ((m & m) == 0)
+            continue;
+          m.Normalize();
+          quadric bq = quadric::Plane(m, -(m & V[a]));
+
+          q[a] += bq, q[b] += bq;
+        }
+      edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+      /* Collapse candidates, stale ones are skipped by vertex versions */
+      struct cand
+      {
+        double Cost;
+        int A, B, VerA, VerB;
+        vec3 P;
+
+        bool operator<( const cand &C ) const
+        {
+          return Cost > C.Cost;
+        }
+      };
+      std::priority_queue<cand> heap;
+      auto push = [&]( int A, int B )
+      {
+        quadric s = q[A];
+
+        s += q[B];
+        vec3 p = s.Best(V[A], V[B]);
+
+        heap.push(cand {std::max(s(p), 0.0), A, B, ver[A], ver[B], p});
+      };
+      for (auto &e : edges)
+        push(e.first, e.second);
+
+      double err = 0;
+      int target = nf / 2;
+      stock<int> na, nb;
+
+      AddLevel(V, F, fdead, 0);
+      while (!heap.empty() && (int)Levels.size() < MaxLevels && alive > 32)
+      {
+        cand c = heap.top();
+
+        heap.pop();
+        if (vdead[c.A] || vdead[c.B] || ver[c.A] != c.VerA || ver[c.B] != c.VerB)
+          continue;
+
+        /* Link condition: common neighbours are only the edge faces apexes */
+        auto ring = [&]( int A, stock<int> &R )
+        {
+          R.clear();
+          for (int f : vf[A])
+            if (!fdead[f])
+              for (int k = 0; k < 3; k++)
+                R << F[f * 3 + k];
+          std::sort(R.begin(), R.end());
+          R.erase(std::unique(R.begin(), R.end()), R.end());
+        };
+        ring(c.A, na), ring(c.B, nb);
+        int common = 0, shared = 0;
+
+        for (int v : na)
+          if (v != c.A && v != c.B && std::binary_search(nb.begin(), nb.end(), v))
+            common++;
+        for (int f : vf[c.A])
+          if (!fdead[f] && (F[f * 3] == c.B || F[f * 3 + 1] == c.B || F[f * 3 + 2] == c.B))
+            shared++;
+        if (common != shared || shared == 0)
+          continue;
+
+        /* Faces must not flip */
+        bool flip = false;
+
+        for (int v : {c.A, c.B})
+          for (int f : vf[v])
+          {
+            if (fdead[f] || flip)
+              continue;
+            int *t = &F[f * 3];
+
+            if ((t[0] == c.A || t[1] == c.A || t[2] == c.A) && (t[0] == c.B || t[1] == c.B || t[2] == c.B))
+              continue;
+            vec3 p[3], o[3];
+
+            for (int k = 0; k < 3; k++)
+              o[k] = V[t[k]], p[k] = t[k] == c.A || t[k] == c.B ? c.P : V[t[k]];
+            if ((((o[1] - o[0]) % (o[2] - o[0])) & ((p[1] - p[0]) % (p[2] - p[0]))) <= 0)
+              flip = true;
+          }
+        if (flip)
+          continue;
+
+        /* Collapse B into A */
+        V[c.A] = c.P;
+        q[c.A] += q[c.B];
+        vdead[c.B] = 1;
+        ver[c.A]++;
+        for (int f : vf[c.B])
+        {
+          if (fdead[f])
+            continue;
+          int *t = &F[f * 3];
+
+          if (t[0] == c.A || t[1] == c.A || t[2] == c.A)
+            fdead[f] = 1, alive--;
+          else
+          {
+            for (int k = 0; k < 3; k++)
+              if (t[k] == c.B)
+                t[k] = c.A;
+            vf[c.A] << f;
+          }
+        }
+        vf[c.B] = stock<int>();
+        vf[c.A].erase(std::remove_if(vf[c.A].begin(), vf[c.A].end(), [&]( int f ){ return fdead[f] != 0; }), vf[c.A].end());
+        err = std::max(err, sqrt(c.Cost));
+
+        ring(c.A, na);
+        for (int v : na)
+          if (v != c.A)
+            push(c.A, v);
+
+        if (alive <= target)
+        {
+          AddLevel(V, F, fdead, err);
+          target = alive / 2;
+        }
+      }
+    } /* End of 'Setup' function */
+
+  public:
+    /* 'lod_mesh' class constructor function.
+     * ARGUMENTS:
+     *   - base mesh (obj or g3dm):
+     *       const mesh_type &Mesh;
+     *   - max number of levels including base one:
+     *       int MaxLevels;
+     *   - allowed error in pixels:
+     *       double Tol;
+     *   - material:
+     *       const material &M;
+     */
+    template<class mesh_type>
+      lod_mesh( const mesh_type &Mesh, int MaxLevels = 8, double Tol = 1, const material &M = material() ) :
+        shape(M), Tolerance(Tol), PixelAngle(0)
+      {
+        Setup(Mesh.GetTris(), std::max(MaxLevels, 1));
+      } /* End of 'lod_mesh' function */
+
+    /* Prepare shape for rendering from camera function.
+     * ARGUMENTS:
+     *   - camera:
+     *       const camera &Cam;
+     * RETURNS: None.
+     */
+    void SetView( const camera &Cam ) override
+    {
+      PixelAngle = Cam.PixelAngle();
+    } /* End of 'SetView' function */
+
+    /* Choose level for ray function.
+     * ARGUMENTS:
+     *   - ray:
+     *       const ray &R;
+     * RETURNS:
+     *   (int) level number, -1 if mesh box is missed.
+     */
+    int Level( const ray &R ) const
+    {
+      float tnear;
+
+      if (Levels[0].Bvh.Nodes.empty() ||
+          !Levels[0].Bvh.Nodes[0].Hit(bvh_ray(R), std::numeric_limits<float>::max(), tnear))
+        return -1;
+
+      double foot = tnear * PixelAngle * Tolerance;
+      int l = (int)Levels.size() - 1;
+
+      while (l > 0 && Levels[l].Err > foot)
+        l--;
+      return l;
+    } /* End of 'Level' function */
+
+    /* Shape intersect virtual function.
+     * ARGUMENTS:
+     *   - ray to intersect with:
+     *       const ray &R;
+     *   - intersection structure:
+     *       intr *Intr;
+     * RETURNS:
+     *   (bool) true if intersected, false otherwise.
+     */
+    bool Intersect( const ray &R, intr *Intr ) override
+    {
+      int l = Level(R), bt = -1;
+
+      if (l == -1)
+        return false;
+
+      const level &lv = Levels[l];
+      double tmax = std::numeric_limits<double>::max();
+
+      lv.Bvh.Traverse(R, tmax,
+        [&]( int First, int Count, double &TMax ) -> bool
+        {
+          bool hit = false;
+
+          for (int i = First; i < First + Count; i++)
+          {
+            const int *tr = &lv.Tris[i * 3];
+            double u, v, t = TriIntersect(lv.P[tr[0]], lv.P[tr[1]], lv.P[tr[2]], R, u, v);
+
+            if (t > Trashold && t < TMax)
+              TMax = t, bt = i, hit = true;
+          }
+          return hit;
+        });
+      if (bt == -1)
+        return false;
+      Intr->T = tmax;
+      Intr->Shp = this;
+      Intr->I[0] = bt;
+      Intr->I[1] = l;
+      return true;
+    } /* End of 'Intersect' function */
+
+    /* Get normal at intersection virtual function.
+     * ARGUMENTS:
+     *   - intersection:
+     *       intr *Intr;
+     * RETURNS: None.
+     */
+    void GetNormal( intr *Intr ) override
+    {
+      const level &lv = Levels[Intr->I[1]];
+      const int *t = &lv.Tris[Intr->I[0] * 3];
+
+      Intr->N = TriNormal(lv.P[t[0]], lv.P[t[1]], lv.P[t[2]], lv.N[t[0]], lv.N[t[1]], lv.N[t[2]], Intr->P);
+    } /* End of 'GetNormal' function */
+
+    /* Get shape bound box function.
+     * ARGUMENTS:
+     *   - box corners to fill:
+     *       vec3 &Min, &Max;
+     * RETURNS:
+     *   (bool) true if shape is bounded, false for infinite shapes.
+     */
+    bool GetBound( vec3 &Min, vec3 &Max ) override
+    {
+      aabb b;
+
+      /* Collapsed vertices may leave base mesh box a little */
+      for (auto &l : Levels)
+        b << l.Bvh.Bound();
+      return b.Get(Min, Max);
+    } /* End of 'GetBound' function */
+  }; /* End of 'lod_mesh' class */
+} /* end of 'tp5' namespace */
+
+#endif /* __lod_mesh_h_ */
+
+/* END OF 'lod_mesh.h' FILE */
@@ -0,0 +1,470 @@
+/* PROJECT     : tp5-rt
+ * FILE NAME   : medium.h
+ * PROGRAMMER  : Tim Peterson
+ * LAST UPDATE : 19.10.2026
+ * PURPOSE     : Participating medium (fog, smoke) shape defenition file.
+ * LICENSE     : MIT License
+ */
+
+#ifndef __medium_h_
+#define __medium_h_
+
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <mutex>
+
+#include "shape.h"
+
+/* Base project namespace */
+namespace tp5
+{
+  /* Participating medium representation class.
+   * Density is kept in a sparse grid of 8x8x8 voxel bricks (empty bricks
+   * take no memory) and sampled trilinearly, extinction is Sigma * density.
+   * Max density of each brick (with one voxel apron) and of each 4x4x4
+   * bricks block form occupancy mip: 3D-DDA walks blocks, then bricks of
+   * occupied blocks, and uses brick max as majorant. Intersection samples
+   * free flight by delta tracking (miss means the ray passed through),
+   * 'Transmittance' uses ratio tracking. Color is the single scattering
+   * albedo, light is scattered equally in all directions.
+   */
+  class medium : public shape
+  {
+  private:
+    static const int BrickSize = 8, BlockSize = 4; // Brick size in voxels, block size in bricks
+
+    vec3 B0, B1, Voxel;          // Bound box and voxel size
+    int N[3], NB[3], NK[3];      // Voxels, bricks and blocks number
+    double Sigma;                // Extinction for density 1
+    stock<int> Bricks;           // Brick numbers in pool, -1 for empty
+    stock<float> Pool;           // Bricks voxels
+    stock<float> BrickMax;       // Bricks majorants
+    stock<float> BlockMax;       // Blocks majorants
+    std::atomic_bool IsBuilt;    // Majorants are up to date flag
+    std::mutex BuildMutex;       // Majorants building lock
+
+    /* Uniform random number in [0, 1) function */
+    static double Rnd( void )
+    {
+      return rnd::Thread().Get();
+    } /* End of 'Rnd' function */
+
+    /* Get voxel density function.
+     * ARGUMENTS:
+     *   - voxel coordinates (clamped to grid):
+     *       int X, Y, Z;
+     * RETURNS:
+     *   (float) density.
+     */
+    float Get( int X, int Y, int Z ) const
+    {
+      X = std::clamp(X, 0, N[0] - 1), Y = std::clamp(Y, 0, N[1] - 1), Z = std::clamp(Z, 0, N[2] - 1);
+
+      int b = Bricks[((Z / BrickSize) * NB[1] + Y / BrickSize) * NB[0] + X / BrickSize];
+
+      if (b < 0)
+        return 0;
+      return Pool[(size_t)b * BrickSize * BrickSize * BrickSize +
+                  ((Z % BrickSize) * BrickSize + Y % BrickSize) * BrickSize + X % BrickSize];
+    } /* End of 'Get' function */
+
+    /* Evaluate extinction at point function.
+     * ARGUMENTS:
+     *   - point:
+     *       const vec3 &P;
+     * RETURNS:
+     *   (double) extinction coefficient.
+     */
+    double Extinction( const vec3 &P ) const
+    {
+      vec3 g = (P - B0) / Voxel - vec3(0.5);
+      int x = (int)std::floor(g.X), y = (int)std::floor(g.Y), z = (int)std::floor(g.Z);
+      double
+        fx = g.X - x, fy = g.Y - y, fz = g.Z - z,
+        c00 = Get(x, y, z) * (1 - fx) + Get(x + 1, y, z) * fx,
+        c10 = Get(x, y + 1, z) * (1 - fx) + Get(x + 1, y + 1, z) * fx,
+        c01 = Get(x, y, z + 1) * (1 - fx) + Get(x + 1, y, z + 1) * fx,
+        c11 = Get(x, y + 1, z + 1) * (1 - fx) + Get(x + 1, y + 1, z + 1) * fx;
+
+      return Sigma * ((c00 * (1 - fy) + c10 * fy) * (1 - fz) + (c01 * (1 - fy) + c11 * fy) * fz);
+    } /* End of 'Extinction' function */
+
+    /* Evaluate majorants function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    void Build( void )
+    {
+      const std::lock_guard<std::mutex> lock(BuildMutex);
+
+      if (IsBuilt)
+        return;
+
+      /* Trilinear lookups in a brick reach one voxel into neighbours */
+      BrickMax.assign(Bricks.size(), 0);
+      BlockMax.assign((size_t)NK[0] * NK[1] * NK[2], 0);
+      for (int bz = 0; bz < NB[2]; bz++)
+        for (int by = 0; by < NB[1]; by++)
+          for (int bx = 0; bx < NB[0]; bx++)
+          {
+            float m = 0;
+
+            for (int z = bz * BrickSize - 1; z <= (bz + 1) * BrickSize; z++)
+              for (int y = by * BrickSize - 1; y <= (by + 1) * BrickSize; y++)
+                for (int x = bx * BrickSize - 1; x <= (bx + 1) * BrickSize; x++)
+                  m = std::max(m, Get(x, y, z));
+            BrickMax[(bz * NB[1] + by) * NB[0] + bx] = (float)(m * Sigma);
+
+            float &k = BlockMax[((bz / BlockSize) * NK[1] + by / BlockSize) * NK[0] + bx / BlockSize];
+
+            k = std::max(k, (float)(m * Sigma));
+          }
+      IsBuilt = true;
+    } /* End of 'Build' function */
+
+    /* Clip ray by bound box function.
+     * ARGUMENTS:
+     *   - ray:
+     *       const ray &R;
+     *   - segment to clip:
+     *       double &T0, &T1;
+     * RETURNS:
+     *   (bool) true if segment is not empty.
+     */
+    bool Clip( const ray &R, double &T0, double &T1 ) const
+    {
+      for (int a = 0; a < 3; a++)
+      {
+        /* Parallel ray: inside slab or missing box, 0 * inf would give NaN */
+        if (R.Dir[a] == 0)
+        {
+          if (R.Org[a] < B0[a] || R.Org[a] > B1[a])
+            return false;
+          continue;
+        }
+
+        double
+          ta = (B0[a] - R.Org[a]) / R.Dir[a],
+          tb = (B1[a] - R.Org[a]) / R.Dir[a];
+
+        if (ta > tb)
+          std::swap(ta, tb);
+        if (ta > T0)
+          T0 = ta;
+        if (tb < T1)
+          T1 = tb;
+      }
+      return T0 < T1;
+    } /* End of 'Clip' function */
+
+    /* 3D-DDA through grid cells function.
+     * ARGUMENTS:
+     *   - grid origin:
+     *       const vec3 &Org;
+     *   - ray and segment:
+     *       const ray &R, double T0, T1;
+     *   - cell size:
+     *       const vec3 &Cell;
+     *   - cells range to walk in [Lo, Hi):
+     *       const int *Lo, *Hi;
+     *   - visitor, bool (int X, int Y, int Z, double T0, double T1), false stops:
+     *       visit_func Visit;
+     * RETURNS:
+     *   (bool) false if stopped by visitor.
+     */
+    template<class visit_func>
+      static bool Dda( const vec3 &Org, const ray &R, double T0, double T1, const vec3 &Cell,
+                       const int *Lo, const int *Hi, visit_func Visit )
+      {
+        vec3 p = R(T0) - Org;
+        int c[3], st[3];
+        double tn[3], td[3];
+
+        for (int a = 0; a < 3; a++)
+        {
+          c[a] = std::clamp((int)std::floor(p[a] / Cell[a]), Lo[a], Hi[a] - 1);
+          st[a] = R.Dir[a] > 0 ? 1 : -1;
+          if (R.Dir[a] == 0)
+            tn[a] = td[a] = std::numeric_limits<double>::max();
+          else
+          {
+            tn[a] = (Org[a] + (c[a] + (R.Dir[a] > 0)) * Cell[a] - R.Org[a]) / R.Dir[a];
+            td[a] = Cell[a] / std::abs(R.Dir[a]);
+          }
+        }
+        for (double t = T0; t < T1; )
+        {
+          int a = tn[0] < tn[1] ? (tn[0] < tn[2] ? 0 : 2) : (tn[1] < tn[2] ? 1 : 2);
+          double te = std::min(tn[a], T1);
+
+          if (te > t && !Visit(c[0], c[1], c[2], t, te))
+            return false;
+          t = te;
+          c[a] += st[a], tn[a] += td[a];
+          if (c[a] < Lo[a] || c[a] >= Hi[a])
+            break;
+        }
+        return true;
+      } /* End of 'Dda' function */
+
+    /* Walk occupied bricks along ray function.
+     * ARGUMENTS:
+     *   - ray and segment:
+     *       const ray &R, double T0, T1;
+     *   - visitor, bool (double T0, double T1, double Majorant), false stops:
+     *       visit_func Visit;
+     * RETURNS: None.
+     */
+    template<class visit_func>
+      void Walk( const ray &R, double T0, double T1, visit_func Visit )
+      {
+        if (!IsBuilt)
+          Build();
+        if (!Clip(R, T0, T1))
+          return;
+
+        const int zero[3] = {0, 0, 0};
+        vec3 brick = Voxel * BrickSize, block = brick * BlockSize;
+
+        Dda(B0, R, T0, T1, block, zero, NK,
+          [&]( int X, int Y, int Z, double Ta, double Tb )
+          {
+            if (BlockMax[(Z * NK[1] + Y) * NK[0] + X] <= 0)
+              return true;
+
+            int
+              lo[3] = {X * BlockSize, Y * BlockSize, Z * BlockSize},
+              hi[3] = {std::min(lo[0] + BlockSize, NB[0]), std::min(lo[1] + BlockSize, NB[1]), std::min(lo[2] + BlockSize, NB[2])};
+
+            return Dda(B0, R, Ta, Tb, brick, lo, hi,
+              [&]( int BX, int BY, int BZ, double Tc, double Td )
+              {
+                double m = BrickMax[(BZ * NB[1] + BY) * NB[0] + BX];
+
+                return m <= 0 || Visit(Tc, Td, m);
+              });
+          });
+      } /* End of 'Walk' function */
+
+  public:
+    /* 'medium' class constructor function.
+     * ARGUMENTS:
+     *   - bound box:
+     *       const vec3 &Min, &Max;
+     *   - grid size in voxels:
+     *       int Nx, Ny, Nz;
+     *   - extinction for density 1:
+     *       double S;
+     *   - material (Kd is single scattering albedo):
+     *       const material &M;
+     */
+    medium( const vec3 &Min, const vec3 &Max, int Nx, int Ny, int Nz, double S,
+            const material &M = material(vec3(0), vec3(0.8)) ) :
+      shape(M), B0(Min), B1(Max), Sigma(S), IsBuilt(false)
+    {
+      N[0] = std::max(Nx, 1), N[1] = std::max(Ny, 1), N[2] = std::max(Nz, 1);
+      for (int a = 0; a < 3; a++)
+      {
+        NB[a] = (N[a] + BrickSize - 1) / BrickSize;
+        NK[a] = (NB[a] + BlockSize - 1) / BlockSize;
+      }
+      Voxel = (B1 - B0) / vec3(N[0], N[1], N[2]);
+      Bricks.assign((size_t)NB[0] * NB[1] * NB[2], -1);
+    } /* End of 'medium' function */
+
+    /* 'medium' class homogeneous constructor function.
+     * ARGUMENTS:
+     *   - bound box:
+     *       const vec3 &Min, &Max;
+     *   - extinction:
+     *       double S;
+     *   - material (Kd is single scattering albedo):
+     *       const material &M;
+     */
+    medium( const vec3 &Min, const vec3 &Max, double S, const material &M = material(vec3(0), vec3(0.8)) ) :
+      medium(Min, Max, 1, 1, 1, S, M)
+    {
+      Set(0, 0, 0, 1);
+    } /* End of 'medium' function */
+
+    /* Set voxel density function (not while rendering).
+     * ARGUMENTS:
+     *   - voxel coordinates:
+     *       int X, Y, Z;
+     *   - density:
+     *       double D;
+     * RETURNS:
+     *   (medium &) self reference.
+     */
+    medium & Set( int X, int Y, int Z, double D )
+    {
+      if (X < 0 || Y < 0 || Z < 0 || X >= N[0] || Y >= N[1] || Z >= N[2])
+        return *this;
+
+      int &b = Bricks[((Z / BrickSize) * NB[1] + Y / BrickSize) * NB[0] + X / BrickSize];
+
+      if (b < 0)
+      {
+        if (D == 0)
+          return *this;
+        b = (int)(Pool.size() / (BrickSize * BrickSize * BrickSize));
+        Pool.resize(Pool.size() + BrickSize * BrickSize * BrickSize, 0);
+      }
+      Pool[(size_t)b * BrickSize * BrickSize * BrickSize +
+           ((Z % BrickSize) * BrickSize + Y % BrickSize) * BrickSize + X % BrickSize] = (float)D;
+      IsBuilt = false;
+      return *this;
+    } /* End of 'Set' function */
+
+    /* Fill density by function at voxel centers function (not while rendering).
+     * ARGUMENTS:
+     *   - density function:
+     *       const std::function<double (const vec3 &P)> &F;
+     * RETURNS:
+     *   (medium &) self reference.
+     */
+    medium & Fill( const std::function<double (const vec3 &P)> &F )
+    {
+      for (int z = 0; z < N[2]; z++)
+        for (int y = 0; y < N[1]; y++)
+          for (int x = 0; x < N[0]; x++)
+            Set(x, y, z, F(B0 + Voxel * vec3(x + 0.5, y + 0.5, z + 0.5)));
+      return *this;
+    } /* End of 'Fill' function */
+
+    /* Get memory used by density function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (size_t) bytes.
+     */
+    size_t Memory( void ) const
+    {
+      return Pool.capacity() * sizeof(float) + Bricks.capacity() * sizeof(int);
+    } /* End of 'Memory' function */
+
+    /* Shape intersect virtual function.
+     * ARGUMENTS:
+     *   - ray to intersect with:
+     *       const ray &R;
+     *   - intersection structure:
+     *       intr *Intr;
+     * RETURNS:
+     *   (bool) true if scattered, false if passed through.
+     */
+    bool Intersect( const ray &R, intr *Intr ) override
+    {
+      bool hit = false;
+
+      /* Delta tracking: tentative collisions by majorant, real ones with
+       * probability of extinction / majorant */
+      Walk(R, Trashold, std::numeric_limits<double>::max(),
+        [&]( double T0, double T1, double M )
+        {
+          for (double t = T0; ; )
+          {
+            t -= std::log(1 - Rnd()) / M;
+            if (t >= T1)
+              return true;
+            if (Rnd() * M < Extinction(R(t)))
+            {
+              Intr->T = t;
+              Intr->Shp = this;
+              hit = true;
+              return false;
+            }
+          }
+        });
+      return hit;
+    } /* End of 'Intersect' function */
+
+    /* Get normal at intersection virtual function.
+     * ARGUMENTS:
+     *   - intersection:
+     *       intr *Intr;
+     * RETURNS: None.
+     */
+    void GetNormal( intr *Intr ) override
+    {
+      Intr->N = vec3(0, 1, 0);
+    } /* End of 'GetNormal' function */
+
+    /* Get shape bound box function.
+     * ARGUMENTS:
+     *   - box corners to fill:
+     *       vec3 &Min, &Max;
+     * RETURNS:
+     *   (bool) true if shape is bounded, false for infinite shapes.
+     */
+    bool GetBound( vec3 &Min, vec3 &Max ) override
+    {
+      Min = B0;
+      Max = B1;
+      return true;
+    } /* End of 'GetBound' function */
+
+    /* Check if point is inside shape function.
+     * ARGUMENTS:
+     *   - point to check:
+     *       const vec3 &P;
+     * RETURNS:
+     *   (bool) true if density is not zero, false, otherwise
+     */
+    bool IsInside( const vec3 &P ) override
+    {
+      return P.X >= B0.X && P.Y >= B0.Y && P.Z >= B0.Z && P.X <= B1.X && P.Y <= B1.Y && P.Z <= B1.Z &&
+        Extinction(P) > 0;
+    } /* End of 'IsInside' function */
+
+    /* Check if intersections are scattering events inside volume function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (bool) true.
+     */
+    bool IsVolume( void ) const override
+    {
+      return true;
+    } /* End of 'IsVolume' function */
+
+    /* Get part of light passing through medium along segment function.
+     * ARGUMENTS:
+     *   - segment start and direction:
+     *       const ray &R;
+     *   - segment length:
+     *       double Dist;
+     * RETURNS:
+     *   (double) transmittance estimate.
+     */
+    double Transmittance( const ray &R, double Dist ) override
+    {
+      double tr = 1;
+
+      /* Ratio tracking, low values end by russian roulette */
+      Walk(R, Trashold, Dist,
+        [&]( double T0, double T1, double M )
+        {
+          for (double t = T0; ; )
+          {
+            t -= std::log(1 - Rnd()) / M;
+            if (t >= T1)
+              return true;
+            tr *= 1 - Extinction(R(t)) / M;
+            if (tr < 0.05)
+            {
+              if (Rnd() < 0.5)
+              {
+                tr = 0;
+                return false;
+              }
+              tr *= 2;
+            }
+          }
+        });
+      return tr;
+    } /* End of 'Transmittance' function */
+  }; /* End of 'medium' class */
+} /* end of 'tp5' namespace */
+
+#endif /* __medium_h_ */
+
+/* END OF 'medium.h' FILE */
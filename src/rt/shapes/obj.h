@@ -68,9 +68,9 @@ namespace tp5
           vec3 P0 = vertexes[v1 - 1].P, P1 = vertexes[v2 - 1].P, P2 = vertexes[v3 - 1].P;
           vec3 N = ((P1 - P0) % (P2 - P0)).Normalizing();
 
-          vertexes[v1].N += N;
-          vertexes[v2].N += N;
-          vertexes[v3].N += N;
+          vertexes[v1 - 1].N += N;
+          vertexes[v2 - 1].N += N;
+          vertexes[v3 - 1].N += N;
           indicies << v1 - 1 << v2 - 1 << v3 - 1;
           Tris << new triangle(P0, P1, P2, M);
         }
@@ -122,6 +122,21 @@ namespace tp5
     {
     } /* End of 'GetNormal' function */
 
+    /* Get shape bound box function.
+     * ARGUMENTS:
+     *   - box corners to fill:
+     *       vec3 &Min, &Max;
+     * RETURNS:
+     *   (bool) true if shape is bounded, false for infinite shapes.
+     */
+    bool GetBound( vec3 &Min, vec3 &Max ) override
+    {
+      if (Tris.empty())
+        return false;
+      GetBoundBox(Min, Max);
+      return true;
+    } /* End of 'GetBound' function */
+
     /* Check if point is inside shape function.
      * ARGUMENTS:
      *   - point to check:
@@ -220,6 +235,16 @@ namespace tp5
           B0.Z = tri->P2.Z;
       }
     } /* End of 'GetBoundBox' function */
+
+    /* Get mesh triangles function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (const stock<triangle *> &) triangles.
+     */
+    const stock<triangle *> & GetTris( void ) const
+    {
+      return Tris;
+    } /* End of 'GetTris' function */
   }; /* End of 'obj' class */
 } /* end of 'tp5' namespace */
 
@@ -10,6 +10,7 @@
 #define __shape_h_
 
 #include "rt/rt_mtl.h"
+#include "rt/rt_packet.h"
 
 namespace tp5
 {
@@ -58,6 +59,44 @@ namespace tp5
     {
     } /* End of 'GetNormal' function */
 
+    /* Get shape bound box function.
+     * ARGUMENTS:
+     *   - box corners to fill:
+     *       vec3 &Min, &Max;
+     * RETURNS:
+     *   (bool) true if shape is bounded, false for infinite shapes.
+     */
+    virtual bool GetBound( vec3 &Min, vec3 &Max )
+    {
+      return false;
+    } /* End of 'GetBound' function */
+
+    /* Intersect rays of packet function.
+     * ARGUMENTS:
+     *   - packet, 'TMax' of closer hits is shrinked:
+     *       ray_packet &P;
+     *   - rays to test bit mask:
+     *       int Mask;
+     *   - closest intersections so far ('Shp' is nullptr if none):
+     *       intr *In;
+     * RETURNS: None.
+     */
+    virtual void IntersectPacket( ray_packet &P, int Mask, intr *In )
+    {
+      for (int i = 0; i < P.N; i++)
+      {
+        intr in;
+
+        if ((Mask >> i & 1) && Intersect(P.R[i], &in) && in.T > 0 && (In[i].Shp == nullptr || in.T < In[i].T))
+        {
+          In[i] = in;
+          if (In[i].Shp == nullptr)
+            In[i].Shp = this;
+          P.Shrink(i, in.T);
+        }
+      }
+    } /* End of 'IntersectPacket' function */
+
     /* Check if point is inside the shape function. 
      * ARGUMENTS:
      *   - point to check:
@@ -82,6 +121,52 @@ namespace tp5
       return 0;
     } /* End of 'AllIntersections' function */
 
+    /* Get material at intersection function.
+     * ARGUMENTS:
+     *   - intersection properties:
+     *       intr *Intr;
+     * RETURNS:
+     *   (const material &) material to shade with.
+     */
+    virtual const material & GetMaterial( intr *Intr )
+    {
+      return Mtl;
+    } /* End of 'GetMaterial' function */
+
+    /* Check if intersections are scattering events inside volume function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (bool) true for participating media, false for surfaces.
+     */
+    virtual bool IsVolume( void ) const
+    {
+      return false;
+    } /* End of 'IsVolume' function */
+
+    /* Get part of light passing through shape along segment function.
+     * ARGUMENTS:
+     *   - segment start and direction:
+     *       const ray &R;
+     *   - segment length:
+     *       double Dist;
+     * RETURNS:
+     *   (double) transmittance, surfaces are handled by intersection and give 1.
+     */
+    virtual double Transmittance( const ray &R, double Dist )
+    {
+      return 1;
+    } /* End of 'Transmittance' function */
+
+    /* Prepare shape for rendering from camera function.
+     * ARGUMENTS:
+     *   - camera:
+     *       const camera &Cam;
+     * RETURNS: None.
+     */
+    virtual void SetView( const camera &Cam )
+    {
+    } /* End of 'SetView' function */
+
     /* Get local shape color function.
      * ARGUMENTS:
      *   - intersection properties:
@@ -91,7 +176,7 @@ namespace tp5
      */
     virtual vec3 Color( intr *Intr )
     {
-      vec3 col = Mtl.Kd;
+      vec3 col = GetMaterial(Intr).Kd;
       for (auto mod : Mods)
       {
         col = (*mod)(mods::mod::mod_info{col, Intr->P, Intr->N});
@@ -20,6 +20,16 @@
 #include "bound.h"
 #include "g3dm.h"
 #include "torus.h"
+#include "heightfield.h"
+#include "transformed.h"
+#include "sphere_set.h"
+#include "splat_cloud.h"
+#include "blob.h"
+#include "subdiv.h"
+#include "displaced.h"
+#include "medium.h"
+#include "curves.h"
+#include "lod_mesh.h"
 
 #endif /* __shapes_h_ */
 
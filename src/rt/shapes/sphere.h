@@ -79,6 +79,61 @@ namespace tp5
       Intr->N = (Intr->P - Center) / Radius;
     } /* End of 'GetNormal' function */
 
+    /* Get shape bound box function.
+     * ARGUMENTS:
+     *   - box corners to fill:
+     *       vec3 &Min, &Max;
+     * RETURNS:
+     *   (bool) true if shape is bounded, false for infinite shapes.
+     */
+    bool GetBound( vec3 &Min, vec3 &Max ) override
+    {
+      Min = Center - vec3(Radius);
+      Max = Center + vec3(Radius);
+      return true;
+    } /* End of 'GetBound' function */
+
+    /* Intersect rays of packet function.
+     * ARGUMENTS:
+     *   - packet, 'TMax' of closer hits is shrinked:
+     *       ray_packet &P;
+     *   - rays to test bit mask:
+     *       int Mask;
+     *   - closest intersections so far ('Shp' is nullptr if none):
+     *       intr *In;
+     * RETURNS: None.
+     */
+    void IntersectPacket( ray_packet &P, int Mask, intr *In ) override
+    {
+      using mth::simd4;
+
+      /* Float test rejects misses, few candidates are checked exactly */
+      float r = (float)(Radius * (1 + 1e-3) + 1e-5 * (!Center + Radius));
+      simd4
+        cx((float)Center.X), cy((float)Center.Y), cz((float)Center.Z),
+        r2(r * r), nr(-r);
+
+      for (int o = 0; o < ray_packet::Size; o += 4)
+      {
+        if (((Mask >> o) & 15) == 0)
+          continue;
+        simd4
+          ax = cx - simd4::Load(P.OX + o), ay = cy - simd4::Load(P.OY + o), az = cz - simd4::Load(P.OZ + o),
+          ok = ax * simd4::Load(P.DX + o) + ay * simd4::Load(P.DY + o) + az * simd4::Load(P.DZ + o),
+          h2 = r2 - (ax * ax + ay * ay + az * az) + ok * ok;
+        int m = (h2 >= simd4(0.0f)).And(ok >= nr).And(ok - Sqrt(Max(h2, simd4(0.0f))) < simd4::Load(P.TMax + o)).Mask() << o;
+
+        m &= Mask;
+        for (int i = o; m != 0 && i < o + 4; i++)
+        {
+          intr in;
+
+          if ((m >> i & 1) && Intersect(P.R[i], &in) && in.T > 0 && (In[i].Shp == nullptr || in.T < In[i].T))
+            In[i] = in, P.Shrink(i, in.T);
+        }
+      }
+    } /* End of 'IntersectPacket' function */
+
     /* Check if point is inside shape function.
      * ARGUMENTS:
      *   - point to check:
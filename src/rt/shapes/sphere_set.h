@@ -0,0 +1,266 @@
+/* PROJECT     : tp5-rt
+ * FILE NAME   : sphere_set.h
+ * PROGRAMMER  : Tim Peterson
+ * LAST UPDATE : 19.10.2026
+ * PURPOSE     : Sphere set (particles) shape defenition file.
+ * LICENSE     : MIT License
+ */
+
+#ifndef __sphere_set_h_
+#define __sphere_set_h_
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "mth/mth_simd.h"
+#include "rt/rt_bvh.h"
+#include "shape.h"
+
+/* Base project namespace */
+namespace tp5
+{
+  /* Many spheres in one shape representation class.
+   * Spheres are kept in float SoA arrays (about 18 bytes per sphere) with
+   * own BVH; leaves are tested 4 spheres at a time. Hierarchy is built on
+   * the first intersection after spheres were added.
+   */
+  class sphere_set : public shape
+  {
+  private:
+    stock<float>
+      CX, CY, CZ, Rad;          // Centers and radiuses
+    stock<uint16_t> MtlNo;      // Material index of each sphere
+    stock<material> Mtls;       // Materials table
+    bvh Bvh;                    // Hierarchy over spheres
+    std::atomic_bool IsBuilt;   // Hierarchy is up to date flag
+    std::mutex BuildMutex;      // Hierarchy building lock
+
+    /* Build hierarchy function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    void Build( void )
+    {
+      const std::lock_guard<std::mutex> lock(BuildMutex);
+
+      if (IsBuilt)
+        return;
+
+      int n = (int)Rad.size();
+
+      Bvh.Build(n,
+        [&]( int I )
+        {
+          fvec3 c(CX[I], CY[I], CZ[I]), r(Rad[I]);
+
+          return aabb(c - r, c + r);
+        });
+      Bvh.Reorder(CX), Bvh.Reorder(CY), Bvh.Reorder(CZ), Bvh.Reorder(Rad), Bvh.Reorder(MtlNo);
+      Bvh.Index = stock<int>();
+
+      /* Pad to whole packs so leaf tests may read past the end */
+      for (int i = 0; i < 3; i++)
+        CX << 0, CY << 0, CZ << 0, Rad << 0;
+      IsBuilt = true;
+    } /* End of 'Build' function */
+
+  public:
+    /* 'sphere_set' class constructor function.
+     * ARGUMENTS:
+     *   - default (number 0) material:
+     *       const material &M;
+     */
+    sphere_set( const material &M = material() ) : shape(M), IsBuilt(false)
+    {
+      Mtls << M;
+    } /* End of 'sphere_set' function */
+
+    /* Add material to table function.
+     * ARGUMENTS:
+     *   - material:
+     *       const material &M;
+     * RETURNS:
+     *   (int) material index.
+     */
+    int AddMaterial( const material &M )
+    {
+      Mtls << M;
+      return (int)Mtls.size() - 1;
+    } /* End of 'AddMaterial' function */
+
+    /* Reserve memory for spheres function.
+     * ARGUMENTS:
+     *   - expected number of spheres:
+     *       size_t N;
+     * RETURNS: None.
+     */
+    void Reserve( size_t N )
+    {
+      CX.reserve(N + 3), CY.reserve(N + 3), CZ.reserve(N + 3), Rad.reserve(N + 3), MtlNo.reserve(N);
+    } /* End of 'Reserve' function */
+
+    /* Add sphere function (not while rendering).
+     * ARGUMENTS:
+     *   - sphere center and radius:
+     *       const vec3 &C, double R;
+     *   - material index (default material is taken for indices out of table or 16 bits):
+     *       int M;
+     * RETURNS:
+     *   (sphere_set &) self reference.
+     */
+    sphere_set & Add( const vec3 &C, double R, int M = 0 )
+    {
+      if (IsBuilt)
+      {
+        /* Drop padding, hierarchy is rebuilt later */
+        CX.resize(MtlNo.size()), CY.resize(MtlNo.size()), CZ.resize(MtlNo.size()), Rad.resize(MtlNo.size());
+        IsBuilt = false;
+      }
+      CX << (float)C.X, CY << (float)C.Y, CZ << (float)C.Z, Rad << (float)R;
+      MtlNo << (uint16_t)(M >= 0 && M < (int)std::min(Mtls.size(), (size_t)0x10000) ? M : 0);
+      return *this;
+    } /* End of 'Add' function */
+
+    /* Shape intersect virtual function.
+     * ARGUMENTS:
+     *   - ray to intersect with:
+     *       const ray &R;
+     *   - intersection structure:
+     *       intr *Intr;
+     * RETURNS:
+     *   (bool) true if intersected, false otherwise.
+     */
+    bool Intersect( const ray &R, intr *Intr ) override
+    {
+      if (!IsBuilt)
+        Build();
+
+      using mth::simd4;
+      simd4
+        ox((float)R.Org.X), oy((float)R.Org.Y), oz((float)R.Org.Z),
+        dx((float)R.Dir.X), dy((float)R.Dir.Y), dz((float)R.Dir.Z),
+        eps((float)Trashold);
+      double tmax = std::numeric_limits<double>::max();
+      int best = -1;
+
+      Bvh.Traverse(R, tmax,
+        [&]( int First, int Count, double &TMax ) -> bool
+        {
+          bool hit = false;
+
+          for (int i = First; i < First + Count; i += 4)
+          {
+            /* Distance from center to ray line is used instead of
+             * |C - O|^2 - R^2 to keep float precision for far spheres */
+            simd4
+              cx = simd4::Load(&CX[i]) - ox,
+              cy = simd4::Load(&CY[i]) - oy,
+              cz = simd4::Load(&CZ[i]) - oz,
+              r  = simd4::Load(&Rad[i]),
+              b  = cx * dx + cy * dy + cz * dz,
+              qx = cx - dx * b, qy = cy - dy * b, qz = cz - dz * b,
+              h  = r * r - (qx * qx + qy * qy + qz * qz),
+              sq = Sqrt(Max(h, simd4(0.0f))),
+              t0 = b - sq,
+              t  = Select(t0 > eps, t0, b + sq),
+              ok = (h >= simd4(0.0f)).And(t > eps).And(t < simd4((float)TMax));
+            int mask = ok.Mask() & ((1 << std::min(4, First + Count - i)) - 1);
+
+            while (mask != 0)
+            {
+              int k = mth::Ctz(mask);
+
+              mask &= mask - 1;
+              if (t[k] < TMax)
+                TMax = t[k], best = i + k, hit = true;
+            }
+          }
+          return hit;
+        });
+      if (best == -1)
+        return false;
+
+      /* Refine distance in double precision */
+      vec3 a = vec3(CX[best], CY[best], CZ[best]) - R.Org;
+      double
+        ok = a & R.Dir,
+        h2 = (double)Rad[best] * Rad[best] - ((a & a) - ok * ok),
+        sq = sqrt(max(h2, 0.0));
+
+      Intr->T = ok - sq > Trashold ? ok - sq : ok + sq;
+      Intr->Shp = this;
+      Intr->I[0] = best;
+      return true;
+    } /* End of 'Intersect' function */
+
+    /* Get normal at intersection virtual function.
+     * ARGUMENTS:
+     *   - intersection:
+     *       intr *Intr;
+     * RETURNS: None.
+     */
+    void GetNormal( intr *Intr ) override
+    {
+      int i = Intr->I[0];
+
+      Intr->N = (Intr->P - vec3(CX[i], CY[i], CZ[i])) / Rad[i];
+    } /* End of 'GetNormal' function */
+
+    /* Get shape bound box function.
+     * ARGUMENTS:
+     *   - box corners to fill:
+     *       vec3 &Min, &Max;
+     * RETURNS:
+     *   (bool) true if shape is bounded, false for infinite shapes.
+     */
+    bool GetBound( vec3 &Min, vec3 &Max ) override
+    {
+      if (!IsBuilt)
+        Build();
+      return Bvh.Bound().Get(Min, Max);
+    } /* End of 'GetBound' function */
+
+    /* Get material at intersection function.
+     * ARGUMENTS:
+     *   - intersection properties:
+     *       intr *Intr;
+     * RETURNS:
+     *   (const material &) material of intersected sphere.
+     */
+    const material & GetMaterial( intr *Intr ) override
+    {
+      return Mtls[MtlNo[Intr->I[0]]];
+    } /* End of 'GetMaterial' function */
+
+    /* Check if point is inside shape function.
+     * ARGUMENTS:
+     *   - point to check:
+     *       const vec3 &P;
+     * RETURNS:
+     *   (bool) true if is inside any sphere, false, otherwise
+     */
+    bool IsInside( const vec3 &P ) override
+    {
+      bool in = false;
+
+      if (!IsBuilt)
+        Build();
+      Bvh.Walk(ray(P, vec3(0, 1, 0)), 0,
+        [&]( int First, int Count )
+        {
+          for (int i = First; i < First + Count && !in; i++)
+          {
+            vec3 d = P - vec3(CX[i], CY[i], CZ[i]);
+
+            in = (d & d) < (double)Rad[i] * Rad[i];
+          }
+        });
+      return in;
+    } /* End of 'IsInside' function */
+  }; /* End of 'sphere_set' class */
+} /* end of 'tp5' namespace */
+
+#endif /* __sphere_set_h_ */
+
+/* END OF 'sphere_set.h' FILE */
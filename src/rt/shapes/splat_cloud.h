@@ -0,0 +1,341 @@
+/* PROJECT     : tp5-rt
+ * FILE NAME   : splat_cloud.h
+ * PROGRAMMER  : Tim Peterson
+ * LAST UPDATE : 19.10.2026
+ * PURPOSE     : Oriented point cloud (surfel splats) shape defenition file.
+ * LICENSE     : MIT License
+ */
+
+#ifndef __splat_cloud_h_
+#define __splat_cloud_h_
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+#include "mth/mth_simd.h"
+#include "rt/rt_bvh.h"
+#include "shape.h"
+
+/* Base project namespace */
+namespace tp5
+{
+  /* Oriented disc cloud representation class.
+   * Every point is rendered as a disc (surfel) with own normal, radius and
+   * color. Discs are kept in float SoA arrays with own BVH, leaves are tested
+   * 4 discs at a time.
+   *
+   * Binary file format (little endian):
+   *   "TP5S", dword count (0 - read up to the end of file), then records of
+   *   float X, Y, Z, NX, NY, NZ, Radius; byte R, G, B, A (32 bytes each).
+   */
+  class splat_cloud : public shape
+  {
+  private:
+    stock<float>
+      PX, PY, PZ,               // Disc centers
+      NX, NY, NZ,               // Disc normals
+      Rad;                      // Disc radiuses
+    stock<dword> Col;           // Disc colors (0xRRGGBBAA)
+    bvh Bvh;                    // Hierarchy over discs
+    std::atomic_bool IsBuilt;   // Hierarchy is up to date flag
+    std::mutex BuildMutex;      // Hierarchy building lock
+
+    /* Single file record */
+    struct record
+    {
+      float P[3], N[3], R;
+      byte C[4];
+    }; /* End of 'record' structure */
+
+    /* Build hierarchy function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    void Build( void )
+    {
+      const std::lock_guard<std::mutex> lock(BuildMutex);
+
+      if (IsBuilt)
+        return;
+
+      Bvh.Build((int)Col.size(),
+        [&]( int I )
+        {
+          /* Tight disc box: extent along axis is R * sqrt(1 - N[axis]^2) */
+          fvec3
+            c(PX[I], PY[I], PZ[I]),
+            e(Rad[I] * std::sqrt(std::max(0.0f, 1 - NX[I] * NX[I])),
+              Rad[I] * std::sqrt(std::max(0.0f, 1 - NY[I] * NY[I])),
+              Rad[I] * std::sqrt(std::max(0.0f, 1 - NZ[I] * NZ[I])));
+
+          return aabb(c - e, c + e);
+        });
+      Bvh.Reorder(PX), Bvh.Reorder(PY), Bvh.Reorder(PZ);
+      Bvh.Reorder(NX), Bvh.Reorder(NY), Bvh.Reorder(NZ);
+      Bvh.Reorder(Rad), Bvh.Reorder(Col);
+      Bvh.Index = stock<int>();
+
+      /* Pad to whole packs so leaf tests may read past the end */
+      for (int i = 0; i < 3; i++)
+        PX << 0, PY << 0, PZ << 0, NX << 0, NY << 0, NZ << 1, Rad << 0;
+      IsBuilt = true;
+    } /* End of 'Build' function */
+
+  public:
+    /* 'splat_cloud' class constructor function.
+     * ARGUMENTS:
+     *   - material:
+     *       const material &M;
+     */
+    splat_cloud( const material &M = material() ) : shape(M), IsBuilt(false)
+    {
+    } /* End of 'splat_cloud' function */
+
+    /* 'splat_cloud' class constructor by file function.
+     * ARGUMENTS:
+     *   - binary point file name:
+     *       const char *FileName;
+     *   - material:
+     *       const material &M;
+     */
+    splat_cloud( const char *FileName, const material &M = material() ) : splat_cloud(M)
+    {
+      Load(FileName);
+    } /* End of 'splat_cloud' function */
+
+    /* Reserve memory for discs function.
+     * ARGUMENTS:
+     *   - expected number of discs:
+     *       size_t N;
+     * RETURNS: None.
+     */
+    void Reserve( size_t N )
+    {
+      for (auto *a : {&PX, &PY, &PZ, &NX, &NY, &NZ, &Rad})
+        a->reserve(N + 3);
+      Col.reserve(N);
+    } /* End of 'Reserve' function */
+
+    /* Add disc function (not while rendering).
+     * ARGUMENTS:
+     *   - center, normal and radius:
+     *       const vec3 &P, &N, double R;
+     *   - color:
+     *       const vec3 &C;
+     * RETURNS:
+     *   (splat_cloud &) self reference.
+     * Discs with zero normal are skipped.
+     */
+    splat_cloud & Add( const vec3 &P, const vec3 &N, double R, const vec3 &C )
+    {
+      auto b = []( double X ) -> dword
+      {
+        return X < 0 ? 0 : X > 1 ? 255 : (dword)(X * 255);
+      };
+      /* Disc without plane would give NaN in intersection test */
+      if ((N & N) == 0)
+        return *this;
+
+      vec3 n = N.Normalizing();
+
+      if (IsBuilt)
+      {
+        /* Drop padding, hierarchy is rebuilt later */
+        for (auto *a : {&PX, &PY, &PZ, &NX, &NY, &NZ, &Rad})
+          a->resize(Col.size());
+        IsBuilt = false;
+      }
+      PX << (float)P.X, PY << (float)P.Y, PZ << (float)P.Z;
+      NX << (float)n.X, NY << (float)n.Y, NZ << (float)n.Z;
+      Rad << (float)R;
+      Col << (b(C.X) << 24 | b(C.Y) << 16 | b(C.Z) << 8 | 0xFF);
+      return *this;
+    } /* End of 'Add' function */
+
+    /* Add disc with material color function.
+     * ARGUMENTS:
+     *   - center, normal and radius:
+     *       const vec3 &P, &N, double R;
+     * RETURNS:
+     *   (splat_cloud &) self reference.
+     */
+    splat_cloud & Add( const vec3 &P, const vec3 &N, double R )
+    {
+      return Add(P, N, R, Mtl.Kd);
+    } /* End of 'Add' function */
+
+    /* Load discs from binary file function.
+     * ARGUMENTS:
+     *   - file name:
+     *       const char *FileName;
+     * RETURNS:
+     *   (int) number of loaded discs, -1 on error.
+     */
+    int Load( const char *FileName )
+    {
+      const size_t chunk = 1 << 16;
+      FILE *F;
+      char sign[4];
+      dword count;
+      int n = 0;
+
+      if ((F = fopen(FileName, "rb")) == nullptr)
+        return -1;
+      if (fread(sign, 1, 4, F) != 4 || memcmp(sign, "TP5S", 4) != 0 || fread(&count, 4, 1, F) != 1)
+      {
+        fclose(F);
+        return -1;
+      }
+
+      /* Records are streamed by chunks, the file is never held in memory.
+       * Nonzero count limits records read, zero normal records are skipped */
+      stock<record> buf;
+      size_t r, left = count != 0 ? count : (size_t)-1;
+      long start = ftell(F), end = -1;
+
+      /* Header count is not trusted for memory, records in file bound it */
+      if (start >= 0 && fseek(F, 0, SEEK_END) == 0)
+        end = ftell(F);
+      if (fseek(F, start, SEEK_SET) != 0)
+      {
+        fclose(F);
+        return -1;
+      }
+      if (end > start)
+        Reserve(Col.size() + std::min(left, (size_t)(end - start) / sizeof(record)));
+      buf.resize(chunk);
+      while (left > 0 && (r = fread(buf.data(), sizeof(record), std::min(chunk, left), F)) > 0)
+      {
+        left -= r;
+        for (size_t i = 0; i < r; i++)
+        {
+          const record &rc = buf[i];
+
+          if (rc.N[0] == 0 && rc.N[1] == 0 && rc.N[2] == 0)
+            continue;
+          Add(vec3(rc.P[0], rc.P[1], rc.P[2]), vec3(rc.N[0], rc.N[1], rc.N[2]), rc.R,
+              vec3(rc.C[0], rc.C[1], rc.C[2]) / 255.0);
+          n++;
+        }
+      }
+      fclose(F);
+      return n;
+    } /* End of 'Load' function */
+
+    /* Shape intersect virtual function.
+     * ARGUMENTS:
+     *   - ray to intersect with:
+     *       const ray &R;
+     *   - intersection structure:
+     *       intr *Intr;
+     * RETURNS:
+     *   (bool) true if intersected, false otherwise.
+     */
+    bool Intersect( const ray &R, intr *Intr ) override
+    {
+      if (!IsBuilt)
+        Build();
+
+      using mth::simd4;
+      simd4
+        ox((float)R.Org.X), oy((float)R.Org.Y), oz((float)R.Org.Z),
+        dx((float)R.Dir.X), dy((float)R.Dir.Y), dz((float)R.Dir.Z),
+        eps((float)Trashold);
+      double tmax = std::numeric_limits<double>::max();
+      int best = -1;
+
+      Bvh.Traverse(R, tmax,
+        [&]( int First, int Count, double &TMax ) -> bool
+        {
+          bool hit = false;
+
+          for (int i = First; i < First + Count; i += 4)
+          {
+            simd4
+              cx = simd4::Load(&PX[i]) - ox,
+              cy = simd4::Load(&PY[i]) - oy,
+              cz = simd4::Load(&PZ[i]) - oz,
+              nx = simd4::Load(&NX[i]),
+              ny = simd4::Load(&NY[i]),
+              nz = simd4::Load(&NZ[i]),
+              r  = simd4::Load(&Rad[i]),
+              dn = dx * nx + dy * ny + dz * nz,
+              t  = (cx * nx + cy * ny + cz * nz) / dn, // Parallel rays give inf/nan, which fail below
+              qx = dx * t - cx, qy = dy * t - cy, qz = dz * t - cz,
+              ok = (qx * qx + qy * qy + qz * qz <= r * r).And(t > eps).And(t < simd4((float)TMax));
+            int mask = ok.Mask() & ((1 << std::min(4, First + Count - i)) - 1);
+
+            while (mask != 0)
+            {
+              int k = mth::Ctz(mask);
+
+              mask &= mask - 1;
+              if (t[k] < TMax)
+                TMax = t[k], best = i + k, hit = true;
+            }
+          }
+          return hit;
+        });
+      if (best == -1)
+        return false;
+
+      /* Refine distance in double precision */
+      vec3 n(NX[best], NY[best], NZ[best]);
+
+      Intr->T = ((vec3(PX[best], PY[best], PZ[best]) - R.Org) & n) / (R.Dir & n);
+      Intr->Shp = this;
+      Intr->I[0] = best;
+      return true;
+    } /* End of 'Intersect' function */
+
+    /* Get normal at intersection virtual function.
+     * ARGUMENTS:
+     *   - intersection:
+     *       intr *Intr;
+     * RETURNS: None.
+     */
+    void GetNormal( intr *Intr ) override
+    {
+      int i = Intr->I[0];
+
+      Intr->N = vec3(NX[i], NY[i], NZ[i]);
+    } /* End of 'GetNormal' function */
+
+    /* Get shape bound box function.
+     * ARGUMENTS:
+     *   - box corners to fill:
+     *       vec3 &Min, &Max;
+     * RETURNS:
+     *   (bool) true if shape is bounded, false for infinite shapes.
+     */
+    bool GetBound( vec3 &Min, vec3 &Max ) override
+    {
+      if (!IsBuilt)
+        Build();
+      return Bvh.Bound().Get(Min, Max);
+    } /* End of 'GetBound' function */
+
+    /* Get local shape color function.
+     * ARGUMENTS:
+     *   - intersection properties:
+     *       intr *Intr;
+     * RETURNS:
+     *   (vec3) disc color with mods applied.
+     */
+    vec3 Color( intr *Intr ) override
+    {
+      dword c = Col[Intr->I[0]];
+      vec3 col = vec3((c >> 24) & 0xFF, (c >> 16) & 0xFF, (c >> 8) & 0xFF) / 255.0;
+
+      for (auto mod : Mods)
+        col = (*mod)(mods::mod::mod_info{col, Intr->P, Intr->N});
+      return col;
+    } /* End of 'Color' function */
+  }; /* End of 'splat_cloud' class */
+} /* end of 'tp5' namespace */
+
+#endif /* __splat_cloud_h_ */
+
+/* END OF 'splat_cloud.h' FILE */
@@ -0,0 +1,566 @@
+/* PROJECT     : tp5-rt
+ * FILE NAME   : subdiv.h
+ * PROGRAMMER  : Tim Peterson
+ * LAST UPDATE : 19.10.2026
+ * PURPOSE     : Lazily tessellated Catmull-Clark surface shape defenition file.
+ * LICENSE     : MIT License
+ */
+
+#ifndef __subdiv_h_
+#define __subdiv_h_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "rt/rt_bvh.h"
+#include "shape.h"
+
+/* Base project namespace */
+namespace tp5
+{
+  /* Catmull-Clark subdivision surface representation class.
+   * Only the control cage is kept. Every cage face is a patch: when a ray
+   * reaches patch bound (hull of the faces around it) the faces sharing a
+   * vertex with it are subdivided 'Level' times, which gives exact
+   * descendants of the center face. Refined patches are kept in a LRU cache
+   * limited by bytes and shared by all render threads, so memory follows
+   * what rays actually reach.
+   */
+  class subdiv : public shape
+  {
+  private:
+    /* Polygon mesh (cage or its part) */
+    struct mesh
+    {
+      stock<vec3> P;      // Vertices
+      stock<int>  FS, FV; // Face starts (one extra at the end) and face vertices
+      stock<byte> Tag;    // Face descends from patch face flag
+
+      /* Get face size function */
+      int Size( int F ) const
+      {
+        return FS[F + 1] - FS[F];
+      } /* End of 'Size' function */
+
+      /* Get face vertex function */
+      int V( int F, int K ) const
+      {
+        return FV[FS[F] + K];
+      } /* End of 'V' function */
+    }; /* End of 'mesh' structure */
+
+    /* Refined patch */
+    struct patch
+    {
+      stock<fvec3> P, N;     // Vertices and normals
+      stock<uint32_t> Tris;  // Triangles vertices (n-gon patch at level 7 has about n * 65 * 65 vertices)
+      bvh Bvh;               // Hierarchy over triangles
+      size_t Bytes;          // Used memory
+    }; /* End of 'patch' structure */
+
+    /* Cache entry */
+    struct entry
+    {
+      std::shared_ptr<const patch> Patch; // Patch, empty if is not cached
+      std::list<int>::iterator It;        // Position in LRU list
+    }; /* End of 'entry' structure */
+
+    mesh Cage;                   // Control cage
+    stock<stock<int>> VF;        // Faces around each cage vertex
+    bvh Bvh;                     // Hierarchy over patch bounds
+    int Level;                   // Number of subdivision steps
+    size_t Budget, Used;         // Cache memory limit and use
+    stock<entry> Cache;          // Cached patches
+    std::list<int> Lru;          // Cached patches, recent first
+    std::mutex CacheMutex;       // Cache lock
+
+    /* Subdivide mesh once function.
+     * ARGUMENTS:
+     *   - mesh to subdivide:
+     *       const mesh &M;
+     * RETURNS:
+     *   (mesh) mesh of quads.
+     */
+    static mesh Subdivide( const mesh &M )
+    {
+      int nv = (int)M.P.size(), nf = (int)M.Tag.size();
+      std::unordered_map<uint64_t, int> edges;
+      stock<int> e0, e1, ef, fe;   // Edge ends, faces per edge, edge of each face side
+      stock<vec3> fp, ep, es;      // Face points, edge points, sum of edge face points
+      mesh r;
+
+      /* Face points and edges */
+      fp.resize(nf);
+      fe.resize(M.FV.size());
+      for (int f = 0; f < nf; f++)
+      {
+        int k = M.Size(f);
+        vec3 s(0);
+
+        for (int i = 0; i < k; i++)
+        {
+          int a = M.V(f, i), b = M.V(f, (i + 1) % k);
+          uint64_t key = (uint64_t)std::min(a, b) << 32 | (uint32_t)std::max(a, b);
+          auto it = edges.find(key);
+
+          s += M.P[a];
+          if (it == edges.end())
+          {
+            it = edges.emplace(key, (int)e0.size()).first;
+            e0 << a, e1 << b, ef << 0, es << vec3(0);
+          }
+          fe[M.FS[f] + i] = it->second;
+        }
+        fp[f] = s / k;
+        for (int i = 0; i < k; i++)
+          ef[fe[M.FS[f] + i]]++, es[fe[M.FS[f] + i]] += fp[f];
+      }
+
+      /* Edge points: boundary edges stay sharp */
+      int ne = (int)e0.size();
+
+      ep.resize(ne);
+      for (int e = 0; e < ne; e++)
+        ep[e] = ef[e] == 2 ? (M.P[e0[e]] + M.P[e1[e]] + es[e]) / 4 : (M.P[e0[e]] + M.P[e1[e]]) / 2;
+
+      /* Vertex points */
+      stock<vec3> fs, rs, bs;
+      stock<int> nfv, nev, nbv;
+
+      fs.resize(nv, vec3(0)), rs.resize(nv, vec3(0)), bs.resize(nv, vec3(0));
+      nfv.resize(nv, 0), nev.resize(nv, 0), nbv.resize(nv, 0);
+
+      for (int f = 0; f < nf; f++)
+        for (int i = 0; i < M.Size(f); i++)
+          fs[M.V(f, i)] += fp[f], nfv[M.V(f, i)]++;
+      for (int e = 0; e < ne; e++)
+      {
+        vec3 mid = (M.P[e0[e]] + M.P[e1[e]]) / 2;
+
+        rs[e0[e]] += mid, rs[e1[e]] += mid, nev[e0[e]]++, nev[e1[e]]++;
+        if (ef[e] == 1)
+          bs[e0[e]] += M.P[e1[e]], bs[e1[e]] += M.P[e0[e]], nbv[e0[e]]++, nbv[e1[e]]++;
+      }
+      r.P.resize(nv);
+      for (int v = 0; v < nv; v++)
+        if (nbv[v] == 0 && nfv[v] > 0)
+        {
+          double n = nfv[v];
+
+          r.P[v] = (fs[v] / n + rs[v] * (2 / (double)nev[v]) + M.P[v] * (n - 3)) / n;
+        }
+        else if (nbv[v] == 2)
+          r.P[v] = (M.P[v] * 6 + bs[v]) / 8;
+        else
+          r.P[v] = M.P[v];
+
+      /* New quads: vertex, next edge, face, previous edge */
+      for (int e = 0; e < ne; e++)
+        r.P << ep[e];
+      for (int f = 0; f < nf; f++)
+        r.P << fp[f];
+      r.FS << 0;
+      for (int f = 0; f < nf; f++)
+      {
+        int k = M.Size(f);
+
+        for (int i = 0; i < k; i++)
+        {
+          r.FV << M.V(f, i) << nv + fe[M.FS[f] + i] << nv + ne + f << nv + fe[M.FS[f] + (i + k - 1) % k];
+          r.FS << (int)r.FV.size();
+          r.Tag << M.Tag[f];
+        }
+      }
+      return r;
+    } /* End of 'Subdivide' function */
+
+    /* Drop faces not sharing a vertex with tagged faces function.
+     * ARGUMENTS:
+     *   - mesh:
+     *       const mesh &M;
+     * RETURNS:
+     *   (mesh) pruned mesh.
+     */
+    static mesh Prune( const mesh &M )
+    {
+      stock<byte> near;
+      stock<int> remap;
+      mesh r;
+
+      near.resize(M.P.size(), 0);
+      remap.resize(M.P.size(), -1);
+      for (int f = 0; f < (int)M.Tag.size(); f++)
+        if (M.Tag[f])
+          for (int i = 0; i < M.Size(f); i++)
+            near[M.V(f, i)] = 1;
+      r.FS << 0;
+      for (int f = 0; f < (int)M.Tag.size(); f++)
+      {
+        bool keep = false;
+
+        for (int i = 0; i < M.Size(f) && !keep; i++)
+          keep = near[M.V(f, i)];
+        if (!keep)
+          continue;
+        for (int i = 0; i < M.Size(f); i++)
+        {
+          int &v = remap[M.V(f, i)];
+
+          if (v == -1)
+            v = (int)r.P.size(), r.P << M.P[M.V(f, i)];
+          r.FV << v;
+        }
+        r.FS << (int)r.FV.size();
+        r.Tag << M.Tag[f];
+      }
+      return r;
+    } /* End of 'Prune' function */
+
+    /* Get cage faces sharing a vertex with patch function.
+     * ARGUMENTS:
+     *   - patch (cage face) number:
+     *       int F;
+     * RETURNS:
+     *   (mesh) local cage, patch face is tagged.
+     */
+    mesh Ring( int F ) const
+    {
+      std::unordered_map<int, int> vmap;
+      stock<int> faces;
+      mesh r;
+
+      for (int i = 0; i < Cage.Size(F); i++)
+        for (int g : VF[Cage.V(F, i)])
+          if (std::find(faces.begin(), faces.end(), g) == faces.end())
+            faces << g;
+      r.FS << 0;
+      for (int g : faces)
+      {
+        for (int i = 0; i < Cage.Size(g); i++)
+        {
+          auto it = vmap.emplace(Cage.V(g, i), (int)r.P.size());
+
+          if (it.second)
+            r.P << Cage.P[Cage.V(g, i)];
+          r.FV << it.first->second;
+        }
+        r.FS << (int)r.FV.size();
+        r.Tag << (byte)(g == F);
+      }
+      return r;
+    } /* End of 'Ring' function */
+
+    /* Refine patch function.
+     * ARGUMENTS:
+     *   - patch (cage face) number:
+     *       int F;
+     * RETURNS:
+     *   (std::shared_ptr<patch>) refined patch.
+     */
+    std::shared_ptr<patch> Refine( int F ) const
+    {
+      auto p = std::make_shared<patch>();
+      mesh m = Ring(F);
+      stock<vec3> vn;
+      stock<int> remap;
+
+      /* Tagged faces depend only on faces sharing a vertex with them */
+      for (int i = 0; i < Level; i++)
+        m = Prune(Subdivide(m));
+
+      /* Normals are averaged over the whole ring, so they match neighbours */
+      vn.resize(m.P.size(), vec3(0));
+      for (int f = 0; f < (int)m.Tag.size(); f++)
+      {
+        vec3 n = (m.P[m.V(f, 2)] - m.P[m.V(f, 0)]) % (m.P[m.V(f, 3)] - m.P[m.V(f, 1)]);
+
+        for (int i = 0; i < 4; i++)
+          vn[m.V(f, i)] += n;
+      }
+      remap.resize(m.P.size(), -1);
+      for (int f = 0; f < (int)m.Tag.size(); f++)
+        if (m.Tag[f])
+        {
+          int v[4];
+
+          for (int i = 0; i < 4; i++)
+          {
+            int &r = remap[m.V(f, i)];
+
+            if (r == -1)
+            {
+              r = (int)p->P.size();
+              p->P << fvec3((float)m.P[m.V(f, i)].X, (float)m.P[m.V(f, i)].Y, (float)m.P[m.V(f, i)].Z);
+              vec3 n = (vn[m.V(f, i)] & vn[m.V(f, i)]) > 0 ? vn[m.V(f, i)].Normalizing() : vec3(0, 1, 0);
+              p->N << fvec3((float)n.X, (float)n.Y, (float)n.Z);
+            }
+            v[i] = r;
+          }
+          p->Tris << v[0] << v[1] << v[2] << v[0] << v[2] << v[3];
+        }
+      p->Bvh.Build((int)p->Tris.size() / 3,
+        [&]( int I )
+        {
+          aabb b;
+
+          return b << p->P[p->Tris[I * 3]] << p->P[p->Tris[I * 3 + 1]] << p->P[p->Tris[I * 3 + 2]];
+        });
+      stock<uint32_t> tris;
+
+      tris.resize(p->Tris.size());
+
+      for (size_t i = 0; i < p->Bvh.Index.size(); i++)
+        for (int k = 0; k < 3; k++)
+          tris[i * 3 + k] = p->Tris[p->Bvh.Index[i] * 3 + k];
+      p->Tris.swap(tris);
+      p->Bvh.Index = stock<int>();
+      p->Bytes = sizeof(patch) + p->P.capacity() * sizeof(fvec3) * 2 +
+        p->Tris.capacity() * sizeof(uint32_t) + p->Bvh.Nodes.capacity() * sizeof(bvh::node);
+      return p;
+    } /* End of 'Refine' function */
+
+    /* Get refined patch from cache function.
+     * ARGUMENTS:
+     *   - patch number:
+     *       int F;
+     * RETURNS:
+     *   (std::shared_ptr<const patch>) patch, valid while is held.
+     */
+    std::shared_ptr<const patch> Get( int F )
+    {
+      {
+        std::lock_guard<std::mutex> lock(CacheMutex);
+        entry &e = Cache[F];
+
+        if (e.Patch)
+        {
+          Lru.splice(Lru.begin(), Lru, e.It);
+          return e.Patch;
+        }
+      }
+
+      /* Refinement is done unlocked, other thread may do the same patch */
+      std::shared_ptr<const patch> p = Refine(F);
+      std::lock_guard<std::mutex> lock(CacheMutex);
+      entry &e = Cache[F];
+
+      if (e.Patch)
+        return e.Patch;
+      e.Patch = p;
+      e.It = Lru.insert(Lru.begin(), F);
+      Used += p->Bytes;
+      while (Used > Budget && Lru.size() > 1)
+      {
+        entry &old = Cache[Lru.back()];
+
+        Used -= old.Patch->Bytes;
+        old.Patch.reset();
+        Lru.pop_back();
+      }
+      return p;
+    } /* End of 'Get' function */
+
+    /* Finish construction function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    void Setup( void )
+    {
+      VF.resize(Cage.P.size());
+      for (int f = 0; f < (int)Cage.Tag.size(); f++)
+        for (int i = 0; i < Cage.Size(f); i++)
+          VF[Cage.V(f, i)] << f;
+      Cache.resize(Cage.Tag.size());
+
+      /* Limit surface lies in convex hull of the ring */
+      Bvh.Build((int)Cage.Tag.size(),
+        [&]( int F )
+        {
+          aabb b;
+
+          for (int i = 0; i < Cage.Size(F); i++)
+            for (int g : VF[Cage.V(F, i)])
+              for (int k = 0; k < Cage.Size(g); k++)
+              {
+                const vec3 &p = Cage.P[Cage.V(g, k)];
+
+                b << fvec3((float)p.X, (float)p.Y, (float)p.Z);
+              }
+          return b;
+        }, 1);
+    } /* End of 'Setup' function */
+
+  public:
+    /* 'subdiv' class constructor function.
+     * ARGUMENTS:
+     *   - cage vertices:
+     *       const stock<vec3> &Points;
+     *   - cage faces (vertex numbers, each face ends with -1):
+     *       const stock<int> &Faces;
+     *   - number of subdivision steps (1 to 7):
+     *       int Steps;
+     *   - cache memory limit in bytes:
+     *       size_t CacheBytes;
+     *   - material:
+     *       const material &M;
+     */
+    subdiv( const stock<vec3> &Points, const stock<int> &Faces, int Steps = 4,
+            size_t CacheBytes = 256 << 20, const material &M = material() ) :
+      shape(M), Level(std::clamp(Steps, 1, 7)), Budget(CacheBytes), Used(0)
+    {
+      Cage.P = Points;
+      Cage.FS << 0;
+      for (int v : Faces)
+        if (v == -1)
+          Cage.FS << (int)Cage.FV.size(), Cage.Tag << 0;
+        else
+          Cage.FV << v;
+      Setup();
+    } /* End of 'subdiv' function */
+
+    /* 'subdiv' class constructor by obj file function.
+     * ARGUMENTS:
+     *   - cage file name:
+     *       const char *FileName;
+     *   - number of subdivision steps (1 to 7):
+     *       int Steps;
+     *   - cache memory limit in bytes:
+     *       size_t CacheBytes;
+     *   - material:
+     *       const material &M;
+     */
+    subdiv( const char *FileName, int Steps = 4, size_t CacheBytes = 256 << 20,
+            const material &M = material() ) :
+      shape(M), Level(std::clamp(Steps, 1, 7)), Budget(CacheBytes), Used(0)
+    {
+      static char line[1000] = "";
+      std::ifstream f(FileName, std::ios::in);
+
+      Cage.FS << 0;
+      while (f.getline(line, 1000))
+        if (line[0] == 'v' && line[1] == ' ')
+        {
+          double x, y, z;
+
+          std::sscanf(line + 2, "%lf %lf %lf", &x, &y, &z);
+          Cage.P << vec3(x, y, z);
+        }
+        else if (line[0] == 'f' && line[1] == ' ')
+        {
+          /* Only position numbers are used: "v", "v/t", "v//n", "v/t/n" */
+          char *s = line + 2;
+          int v, n;
+
+          while (std::sscanf(s, " %d%n", &v, &n) == 1)
+          {
+            Cage.FV << (v < 0 ? (int)Cage.P.size() + v : v - 1);
+            s += n;
+            while (*s != 0 && *s != ' ' && *s != '\t')
+              s++;
+          }
+          Cage.FS << (int)Cage.FV.size(), Cage.Tag << 0;
+        }
+      Setup();
+    } /* End of 'subdiv' function */
+
+    /* Get cache memory use function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (size_t) bytes used by refined patches.
+     */
+    size_t CacheUsed( void )
+    {
+      std::lock_guard<std::mutex> lock(CacheMutex);
+
+      return Used;
+    } /* End of 'CacheUsed' function */
+
+    /* Shape intersect virtual function.
+     * ARGUMENTS:
+     *   - ray to intersect with:
+     *       const ray &R;
+     *   - intersection structure:
+     *       intr *Intr;
+     * RETURNS:
+     *   (bool) true if intersected, false otherwise.
+     */
+    bool Intersect( const ray &R, intr *Intr ) override
+    {
+      double tmax = std::numeric_limits<double>::max();
+      int bp = -1, bt = -1;
+
+      Bvh.Traverse(R, tmax,
+        [&]( int First, int Count, double &TMax ) -> bool
+        {
+          bool hit = false;
+
+          for (int f = First; f < First + Count; f++)
+          {
+            int pf = Bvh.Index[f];
+            std::shared_ptr<const patch> p = Get(pf);
+
+            hit |= p->Bvh.Traverse(R, TMax,
+              [&]( int TFirst, int TCount, double &TMax ) -> bool
+              {
+                bool h = false;
+                double u, v;
+
+                for (int i = TFirst; i < TFirst + TCount; i++)
+                {
+                  const uint32_t *tr = &p->Tris[i * 3];
+                  double t = TriIntersect(p->P[tr[0]], p->P[tr[1]], p->P[tr[2]], R, u, v);
+
+                  if (t > Trashold && t < TMax)
+                    TMax = t, bp = pf, bt = i, h = true;
+                }
+                return h;
+              });
+          }
+          return hit;
+        });
+      if (bp == -1)
+        return false;
+      Intr->T = tmax;
+      Intr->Shp = this;
+      Intr->I[0] = bp;
+      Intr->I[1] = bt;
+      return true;
+    } /* End of 'Intersect' function */
+
+    /* Get normal at intersection virtual function.
+     * ARGUMENTS:
+     *   - intersection:
+     *       intr *Intr;
+     * RETURNS: None.
+     */
+    void GetNormal( intr *Intr ) override
+    {
+      std::shared_ptr<const patch> p = Get(Intr->I[0]);
+      const uint32_t *t = &p->Tris[Intr->I[1] * 3];
+
+      Intr->N = TriNormal(p->P[t[0]], p->P[t[1]], p->P[t[2]], p->N[t[0]], p->N[t[1]], p->N[t[2]], Intr->P);
+    } /* End of 'GetNormal' function */
+
+    /* Get shape bound box function.
+     * ARGUMENTS:
+     *   - box corners to fill:
+     *       vec3 &Min, &Max;
+     * RETURNS:
+     *   (bool) true if shape is bounded, false for infinite shapes.
+     */
+    bool GetBound( vec3 &Min, vec3 &Max ) override
+    {
+      return Bvh.Bound().Get(Min, Max);
+    } /* End of 'GetBound' function */
+  }; /* End of 'subdiv' class */
+} /* end of 'tp5' namespace */
+
+#endif /* __subdiv_h_ */
+
+/* END OF 'subdiv.h' FILE */
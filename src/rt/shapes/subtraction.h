@@ -89,6 +89,30 @@ namespace tp5
       void GetNormal( intr *Intr ) override
       {
       } /* End of 'GetNormal' function */
+
+      /* Get shape bound box function.
+       * ARGUMENTS:
+       *   - box corners to fill:
+       *       vec3 &Min, &Max;
+       * RETURNS:
+       *   (bool) true if shape is bounded, false for infinite shapes.
+       */
+      bool GetBound( vec3 &Min, vec3 &Max ) override
+      {
+        return ShpA->GetBound(Min, Max);
+      } /* End of 'GetBound' function */
+
+      /* Prepare shape for rendering from camera function.
+       * ARGUMENTS:
+       *   - camera:
+       *       const camera &Cam;
+       * RETURNS: None.
+       */
+      void SetView( const camera &Cam ) override
+      {
+        ShpA->SetView(Cam);
+        ShpB->SetView(Cam);
+      } /* End of 'SetView' function */
     }; /* End of 'subtraction' class */
   } /* end of 'csg' namespace */
 } /* end of 'tp5' namespace */
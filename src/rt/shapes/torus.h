@@ -44,17 +44,19 @@ namespace tp5
      */
     bool Intersect( const ray &Ray, intr *Intr ) override
     {
+      /* Quartic coefficients lose too much in single precision */
+      dvec3 Org = Ray.Org, Dir = Ray.Dir;
       double
         R2 = R * R,
         R02 = R0 * R0; 
       double 
-        A = Ray.Org & Ray.Org,
-        B = Ray.Org & Ray.Dir * 2.,
-        C = Ray.Dir & Ray.Dir,
+        A = Org & Org,
+        B = Org & Dir * 2.,
+        C = Dir & Dir,
         D = R2 - R02,
-        E = A - Ray.Org.Z * Ray.Org.Z,
-        F = B - Ray.Dir.Z * Ray.Org.Z * 2.,
-        G = C - Ray.Dir.Z * Ray.Dir.Z;
+        E = A - Org.Z * Org.Z,
+        F = B - Dir.Z * Org.Z * 2.,
+        G = C - Dir.Z * Dir.Z;
       double
         A_D = A + D,
         C2  = C * C,
@@ -68,7 +70,7 @@ namespace tp5
       //mth::DComplex *x = new mth::DComplex[4];
       mth::DComplex *x = mth::poly::solveP4(A0, B0, C0, D0);
 
-      float bestx = 10000.;
+      double bestx = 10000.;
       int   besti = -1;
       bool  yes   = false;
 
@@ -102,6 +104,20 @@ namespace tp5
       Intr->N = (Intr->P - vec3(Intr->P.X, Intr->P.Y, 0).Normalizing() * R).Normalizing();
     } /* End of 'GetNormal' function */
 
+    /* Get shape bound box function.
+     * ARGUMENTS:
+     *   - box corners to fill:
+     *       vec3 &Min, &Max;
+     * RETURNS:
+     *   (bool) true if shape is bounded, false for infinite shapes.
+     */
+    bool GetBound( vec3 &Min, vec3 &Max ) override
+    {
+      Max = vec3(R + R0, R + R0, R0);
+      Min = -Max;
+      return true;
+    } /* End of 'GetBound' function */
+
     /* Check if point is inside shape function.
      * ARGUMENTS:
      *   - point to check:
@@ -0,0 +1,207 @@
+/* PROJECT     : tp5-rt
+ * FILE NAME   : transformed.h
+ * PROGRAMMER  : Tim Peterson
+ * LAST UPDATE : 19.10.2026
+ * PURPOSE     : Transformed shape wrapper defenition file.
+ * LICENSE     : MIT License
+ */
+
+#ifndef __transformed_h_
+#define __transformed_h_
+
+#include "shape.h"
+
+/* Base project namespace */
+namespace tp5
+{
+  /* Transformed shape wrapper representation class.
+   * Rays are moved into object space of the wrapped shape, hits are moved
+   * back to world space. All matrices are evaluated once in the constructor
+   * and never change afterwards, so one wrapper may be used by all render
+   * threads at once. Material and mods are taken from the wrapped shape.
+   */
+  class transformed : public shape
+  {
+  private:
+    shape *Shape; // Wrapped shape
+    matr
+      M,          // Object to world matrix
+      MInv,       // World to object matrix
+      MInvT;      // Normal object to world matrix (inverse transposed)
+
+    /* Convert object space intersection to world space function.
+     * ARGUMENTS:
+     *   - world space ray:
+     *       const ray &R;
+     *   - object space point and normal:
+     *       const vec3 &P, &N;
+     *   - intersection to fill:
+     *       intr *Intr;
+     * RETURNS: None.
+     */
+    void ToWorld( const ray &R, const vec3 &P, const vec3 &N, intr *Intr ) const
+    {
+      vec3 n = MInvT.VectorTransform(N);
+
+      Intr->P = M.PointTransform(P);
+      Intr->T = (Intr->P - R.Org) & R.Dir;
+      Intr->N = (n & n) > 0 ? n.Normalizing() : n;
+    } /* End of 'ToWorld' function */
+
+  public:
+    /* 'transformed' class constructor function.
+     * ARGUMENTS:
+     *   - shape to transform:
+     *       shape *S;
+     *   - object to world matrix:
+     *       const matr &Transform;
+     */
+    transformed( shape *S, const matr &Transform ) :
+      shape(S->Mtl), Shape(S), M(Transform), MInv(Transform.Inverse()), MInvT(MInv.Transposed())
+    {
+    } /* End of 'transformed' function */
+
+    /* Shape intersect virtual function.
+     * ARGUMENTS:
+     *   - ray to intersect with:
+     *       const ray &R;
+     *   - intersection structure:
+     *       intr *Intr;
+     * RETURNS:
+     *   (bool) true if intersected, false otherwise.
+     */
+    bool Intersect( const ray &R, intr *Intr ) override
+    {
+      ray r(MInv.PointTransform(R.Org), MInv.VectorTransform(R.Dir));
+      intr in;
+
+      if (!Shape->Intersect(r, &in))
+        return false;
+
+      /* Normal is evaluated here: object space point is lost after return */
+      in.P = r(in.T);
+      in.Shp->GetNormal(&in);
+      *Intr = in;
+      ToWorld(R, in.P, in.N, Intr);
+      Intr->Shp = this;
+      return true;
+    } /* End of 'Intersect' function */
+
+    /* Get normal at intersection virtual function.
+     * ARGUMENTS:
+     *   - intersection:
+     *       intr *Intr;
+     * RETURNS: None.
+     */
+    void GetNormal( intr *Intr ) override
+    {
+    } /* End of 'GetNormal' function */
+
+    /* Get shape bound box function.
+     * ARGUMENTS:
+     *   - box corners to fill:
+     *       vec3 &Min, &Max;
+     * RETURNS:
+     *   (bool) true if shape is bounded, false for infinite shapes.
+     */
+    bool GetBound( vec3 &Min, vec3 &Max ) override
+    {
+      vec3 b0, b1;
+
+      if (!Shape->GetBound(b0, b1))
+        return false;
+      Min = vec3(std::numeric_limits<double>::max());
+      Max = -Min;
+      for (int i = 0; i < 8; i++)
+      {
+        vec3 p = M.PointTransform(vec3(i & 1 ? b1.X : b0.X, i & 2 ? b1.Y : b0.Y, i & 4 ? b1.Z : b0.Z));
+
+        Min = vec3(std::min(Min.X, p.X), std::min(Min.Y, p.Y), std::min(Min.Z, p.Z));
+        Max = vec3(std::max(Max.X, p.X), std::max(Max.Y, p.Y), std::max(Max.Z, p.Z));
+      }
+      return true;
+    } /* End of 'GetBound' function */
+
+    /* Check if point is inside shape function.
+     * ARGUMENTS:
+     *   - point to check:
+     *       const vec3 &P;
+     * RETURNS:
+     *   (bool) true if is inside, false, otherwise
+     */
+    bool IsInside( const vec3 &P ) override
+    {
+      return Shape->IsInside(MInv.PointTransform(P));
+    } /* End of 'IsInside' function */
+
+    /* Get list of all intersections with ray function.
+     * ARGUMENTS:
+     *   - list of all intersections:
+     *       intr_list &IL;
+     * RETURNS:
+     *   (int) number of intersections.
+     */
+    int AllIntersections( const ray &R, intr_list &IL ) override
+    {
+      ray r(MInv.PointTransform(R.Org), MInv.VectorTransform(R.Dir));
+      intr_list il;
+      int n = Shape->AllIntersections(r, il);
+
+      /* Normals are evaluated in object space, as in 'Intersect' */
+      for (auto &in : il)
+      {
+        in.P = r(in.T);
+        in.Shp->GetNormal(&in);
+        ToWorld(R, in.P, in.N, &in);
+        in.Shp = this;
+        IL << in;
+      }
+      return n;
+    } /* End of 'AllIntersections' function */
+
+    /* Prepare shape for rendering from camera function.
+     * ARGUMENTS:
+     *   - camera:
+     *       const camera &Cam;
+     * RETURNS: None.
+     */
+    void SetView( const camera &Cam ) override
+    {
+      /* Object space distances along normalized rays keep footprint ratio */
+      Shape->SetView(Cam);
+    } /* End of 'SetView' function */
+
+    /* Get material at intersection function.
+     * ARGUMENTS:
+     *   - intersection properties:
+     *       intr *Intr;
+     * RETURNS:
+     *   (const material &) material of wrapped shape.
+     */
+    const material & GetMaterial( intr *Intr ) override
+    {
+      return Shape->GetMaterial(Intr);
+    } /* End of 'GetMaterial' function */
+
+    /* Get local shape color function.
+     * ARGUMENTS:
+     *   - intersection properties:
+     *       intr *Intr;
+     * RETURNS:
+     *   (vec3) result color.
+     */
+    vec3 Color( intr *Intr ) override
+    {
+      intr in = *Intr;
+
+      /* Mods are evaluated in object space, so textures follow the shape */
+      in.P = MInv.PointTransform(Intr->P);
+      in.N = M.Transposed().VectorTransform(Intr->N).Normalizing();
+      return Shape->Color(&in);
+    } /* End of 'Color' function */
+  }; /* End of 'transformed' class */
+} /* end of 'tp5' namespace */
+
+#endif /* __transformed_h_ */
+
+/* END OF 'transformed.h' FILE */
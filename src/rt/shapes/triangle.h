@@ -19,6 +19,8 @@ namespace tp5
   {
     friend class obj;
     friend class g3dm;
+    friend class displaced;
+    friend class lod_mesh;
   protected:
     vec3   P0, P1, P2;    // Triangle vertexes
     vec3   N, N1, N2, N3; // Normal (evaluated in constructor)
@@ -110,6 +112,20 @@ namespace tp5
     void GetNormal( intr *Intr ) override
     {
     } /* End of 'GetNormal' function */
+
+    /* Get shape bound box function.
+     * ARGUMENTS:
+     *   - box corners to fill:
+     *       vec3 &Min, &Max;
+     * RETURNS:
+     *   (bool) true if shape is bounded, false for infinite shapes.
+     */
+    bool GetBound( vec3 &Min, vec3 &Max ) override
+    {
+      Min = vec3(std::min({P0.X, P1.X, P2.X}), std::min({P0.Y, P1.Y, P2.Y}), std::min({P0.Z, P1.Z, P2.Z}));
+      Max = vec3(std::max({P0.X, P1.X, P2.X}), std::max({P0.Y, P1.Y, P2.Y}), std::max({P0.Z, P1.Z, P2.Z}));
+      return true;
+    } /* End of 'GetBound' function */
   }; /* End of 'triangle' class */
 } /* end of 'tp5' namespace */
 
@@ -102,6 +102,15 @@ namespace tp5
         case SDL_KEYDOWN:
           this->OnKeyDown(event.key.keysym);
           break;
+        case SDL_KEYUP:
+          this->OnKeyUp(event.key.keysym);
+          break;
+        case SDL_MOUSEMOTION:
+          this->OnMouseMove(event.motion.xrel, event.motion.yrel, event.motion.state);
+          break;
+        case SDL_MOUSEWHEEL:
+          this->OnMouseWheel(event.wheel.y);
+          break;
         case SDL_WINDOWEVENT:
           if (event.window.event == SDL_WINDOWEVENT_RESIZED) 
           {
@@ -130,6 +139,35 @@ namespace tp5
   {
   } /* End of 'OnKeyDown' method */
 
+  /* On key up call-back virtual method.
+   * ARGUMENTS:
+   *   - released key:
+   *        SDL_Keysym KeySym;
+   */
+  void window::OnKeyUp( SDL_Keysym KeySym )
+  {
+  } /* End of 'OnKeyUp' method */
+
+  /* On mouse move call-back virtual method.
+   * ARGUMENTS:
+   *   - cursor shift in pixels:
+   *        int Dx, Dy;
+   *   - pressed buttons mask (SDL_BUTTON_LMASK, ...):
+   *        dword Buttons;
+   */
+  void window::OnMouseMove( int Dx, int Dy, dword Buttons )
+  {
+  } /* End of 'OnMouseMove' method */
+
+  /* On mouse wheel call-back virtual method.
+   * ARGUMENTS:
+   *   - wheel turn (positive is away from user):
+   *        int Dz;
+   */
+  void window::OnMouseWheel( int Dz )
+  {
+  } /* End of 'OnMouseWheel' method */
+
   /* On resize call-back virtual method.
    * ARGUMENTS:
    *   - new size:
@@ -73,6 +73,29 @@ namespace tp5
      *   'KeySym.sym' for exact symbol;
      */
     virtual void OnKeyDown( SDL_Keysym KeySym );
+
+    /* On key up call-back virtual method.
+     * ARGUMENTS:
+     *   - released key:
+     *        SDL_Keysym KeySym;
+     */
+    virtual void OnKeyUp( SDL_Keysym KeySym );
+
+    /* On mouse move call-back virtual method.
+     * ARGUMENTS:
+     *   - cursor shift in pixels:
+     *        int Dx, Dy;
+     *   - pressed buttons mask (SDL_BUTTON_LMASK, ...):
+     *        dword Buttons;
+     */
+    virtual void OnMouseMove( int Dx, int Dy, dword Buttons );
+
+    /* On mouse wheel call-back virtual method.
+     * ARGUMENTS:
+     *   - wheel turn (positive is away from user):
+     *        int Dz;
+     */
+    virtual void OnMouseWheel( int Dz );
  
     /* On resize call-back virtual method.
      * ARGUMENTS: